@@ -2,35 +2,54 @@
 
 using namespace std;
 
-Board::Board(int w, int h) : width(w), height(h) {
-	initBoard();
+/*********************************** HASHING **********************************/
+
+// Keys are generated from a fixed seed so that every process hashes a position the same way
+static uint64_t splitMix64(uint64_t x) {
+	x += 0x9E3779B97F4A7C15ULL;
+	x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+	x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+	return x ^ (x >> 31);
 }
 
-// Copy constructor
-Board::Board(const Board &b) {
-	width = b.width;
-	height = b.height;
-	data = new int*[width];
+static uint64_t getZobristKey(int player, int index) {
+	return (player == EMPTY) ? 0 : splitMix64(index * 3 + player);
+}
 
-	for (int i = 0; i < width; i++) {
-		data[i] = new int[height];
+// Hashed in when it is WHITE's turn to move
+static const uint64_t ZOBRIST_WHITE_TO_MOVE = splitMix64(0);
 
-		for (int j = 0; j < height; j++) {
-			data[i][j] = b.data[i][j];
+// Keys of each cell of a bitboard, and the change in key when the disk on the cell is flipped
+static uint64_t ZOBRIST_KEYS[3][BITBOARD_MAX_CELLS];
+static uint64_t ZOBRIST_FLIP_KEYS[BITBOARD_MAX_CELLS];
+static bool initZobristKeys() {
+	for (int i = 0; i < BITBOARD_MAX_CELLS; i++) {
+		for (int player = EMPTY; player <= WHITE; player++) {
+			ZOBRIST_KEYS[player][i] = getZobristKey(player, i);
 		}
+		ZOBRIST_FLIP_KEYS[i] = ZOBRIST_KEYS[BLACK][i] ^ ZOBRIST_KEYS[WHITE][i];
 	}
+	return true;
 }
+static bool zobristKeysInitialized = initZobristKeys();
 
-void Board::initBoard() {
-	// Initialize 2D Array
-	data = new int*[width];
-	for (int i = 0; i < width; i++) {
-		data[i] = new int[height];
+/************************************ BOARD ***********************************/
 
-		// Initialize all to Empty
-		for (int j = 0; j < height; j++) {
-			data[i][j] = EMPTY;
-		}
+Board::Board(int w, int h) : width(w), height(h) {
+	useBitboard = (width * height <= BITBOARD_MAX_CELLS && width > 1 && height > 1);
+	initMasks();
+	initBoard();
+}
+
+void Board::initBoard() {
+	// Initialize all to Empty
+	blackDisks = 0;
+	whiteDisks = 0;
+	hash = 0;
+	history.clear();
+	largeFlips.clear();
+	if (!useBitboard) {
+		data.assign(width * height, EMPTY);
 	}
 }
 
@@ -46,57 +65,341 @@ void Board::initBoard(vector<point> whiteStarting, vector<point> blackStarting)
 	}
 }
 
+// Precompute the masks used for shifting the bitboards in each direction
+void Board::initMasks() {
+	fullMask = 0;
+	cornerMask = 0;
+	edgeMask = 0;
+	if (!useBitboard) {
+		return;
+	}
+
+	uint64_t firstRow = 0;
+	uint64_t lastRow = 0;
+	for (int i = 0; i < width; i++) {
+		for (int j = 0; j < height; j++) {
+			uint64_t bit = 1ULL << (i * height + j);
+			fullMask |= bit;
+			firstRow |= (j == 0) ? bit : 0;
+			lastRow |= (j == height - 1) ? bit : 0;
+			cornerMask |= isCorner(i, j) ? bit : 0;
+			edgeMask |= isEdge(i, j) ? bit : 0;
+		}
+	}
+
+	for (int d = 0; d < 8; d++) {
+		// Moving along y shifts by 1 bit, moving along x shifts by a whole column
+		directionShift[d] = DIRECTION[d][0] * height + DIRECTION[d][1];
+
+		// Moving down a column must not wrap into the top of the next column (and vice versa)
+		directionMask[d] = fullMask;
+		if (DIRECTION[d][1] == 1) {
+			directionMask[d] &= ~firstRow;
+		} else if (DIRECTION[d][1] == -1) {
+			directionMask[d] &= ~lastRow;
+		}
+	}
+}
+
 // Helpers
 int Board::getDisk(int x, int y) {
-	return data[x][y];
+	if (!useBitboard) {
+		return data[x * height + y];
+	}
+	uint64_t bit = 1ULL << (x * height + y);
+	if (blackDisks & bit) {
+		return BLACK;
+	} else if (whiteDisks & bit) {
+		return WHITE;
+	}
+	return EMPTY;
 }
 void Board::flipDisk(int x, int y) {
-	data[x][y] = OPP(data[x][y]);
+	setDisk(OPP(getDisk(x, y)), x, y);
 }
 void Board::setDisk(int player, int x, int y) {
-	data[x][y] = player;
+	int index = x * height + y;
+	hash ^= getZobristKey(getDisk(x, y), index) ^ getZobristKey(player, index);
+	if (!useBitboard) {
+		data[index] = player;
+		return;
+	}
+	uint64_t bit = 1ULL << (x * height + y);
+	blackDisks = (player == BLACK) ? (blackDisks | bit) : (blackDisks & ~bit);
+	whiteDisks = (player == WHITE) ? (whiteDisks | bit) : (whiteDisks & ~bit);
+}
+uint64_t Board::getHash(int player) {
+	return (player == WHITE) ? (hash ^ ZOBRIST_WHITE_TO_MOVE) : hash;
 }
 bool Board::inRange(int x, int y) {
 	return (x >= 0 && x < width && y >= 0 && y < height);
 }
+bool Board::isCorner(int x, int y) {
+	return (x == 0 || x == width - 1) && (y == 0 || y == height - 1);
+}
+bool Board::isEdge(int x, int y) {
+	return (x == 0 || x == width - 1 || y == 0 || y == height - 1) && !isCorner(x, y);
+}
 
 int Board::getNumEmpty() {
+	return width * height - countDisks(BLACK) - countDisks(WHITE);
+}
+
+// Counting
+int Board::countDisks(int player) {
+	if (useBitboard) {
+		return __builtin_popcountll((player == BLACK) ? blackDisks : whiteDisks);
+	}
 	int count = 0;
-	for (int i = 0; i < height; i++) {
-		for (int j = 0; j < width; j++) {
-			if (data[i][j] == EMPTY) {
-				count++;
-			} 
+	for (int i = 0; i < width * height; i++) {
+		count += (data[i] == player);
+	}
+	return count;
+}
+
+int Board::countCornerDisks(int player) {
+	if (useBitboard) {
+		return __builtin_popcountll(((player == BLACK) ? blackDisks : whiteDisks) & cornerMask);
+	}
+	int count = 0;
+	for (int i = 0; i < width; i++) {
+		for (int j = 0; j < height; j++) {
+			count += (isCorner(i, j) && getDisk(i, j) == player);
 		}
 	}
 	return count;
 }
 
+int Board::countEdgeDisks(int player) {
+	if (useBitboard) {
+		return __builtin_popcountll(((player == BLACK) ? blackDisks : whiteDisks) & edgeMask);
+	}
+	int count = 0;
+	for (int i = 0; i < width; i++) {
+		for (int j = 0; j < height; j++) {
+			count += (isEdge(i, j) && getDisk(i, j) == player);
+		}
+	}
+	return count;
+}
+
+/********************************** BITBOARD **********************************/
+
+// Moves every disk one step in direction d, dropping disks that leave the board
+inline uint64_t Board::shiftDisks(uint64_t disks, int d) {
+	int shift = directionShift[d];
+	disks = (shift > 0) ? (disks << shift) : (disks >> -shift);
+	return disks & directionMask[d];
+}
+
+// Empty cells that are next to a line of opponent disks which ends with one of player's disks
+uint64_t Board::getValidMovesMask(int player) {
+	uint64_t own = (player == BLACK) ? blackDisks : whiteDisks;
+	uint64_t opp = (player == BLACK) ? whiteDisks : blackDisks;
+	uint64_t empty = fullMask & ~(own | opp);
+	uint64_t moves = 0;
+
+	for (int d = 0; d < 8; d++) {
+		// Flood from player's disks through consecutive opponent disks
+		uint64_t line = shiftDisks(own, d) & opp;
+		uint64_t previous = 0;
+		while (line != previous) {
+			previous = line;
+			line |= shiftDisks(line, d) & opp;
+		}
+		moves |= shiftDisks(line, d) & empty;
+	}
+	return moves;
+}
+
+// Opponent disks that will be flipped if player places a disk at (x, y)
+uint64_t Board::getFlipsMask(int player, int x, int y) {
+	uint64_t own = (player == BLACK) ? blackDisks : whiteDisks;
+	uint64_t opp = (player == BLACK) ? whiteDisks : blackDisks;
+	uint64_t move = 1ULL << (x * height + y);
+	uint64_t flips = 0;
+
+	for (int d = 0; d < 8; d++) {
+		uint64_t line = 0;
+		uint64_t next = shiftDisks(move, d);
+		while (next & opp) {
+			line |= next;
+			next = shiftDisks(next, d);
+		}
+		// Line of opponent disks has to be closed off by player's disk
+		if (next & own) {
+			flips |= line;
+		}
+	}
+	return flips;
+}
+
+/************************************ MOVES ***********************************/
+
 // Checks if player can place disk at (x, y)
 bool Board::isValidMove(int player, int x, int y) {
-	// Not valid if there is a Disk on it already OR if it is out of board's range
-	if (data[x][y] != EMPTY || !inRange(x, y)) {
+	// Not valid if it is out of board's range OR if there is a Disk on it already
+	if (!inRange(x, y) || getDisk(x, y) != EMPTY) {
 		return false;
 	}
-	
+	if (!useBitboard) {
+		return isValidLargeMove(player, x, y);
+	}
+	return getFlipsMask(player, x, y) != 0;
+}
+
+// Retrieves all valid moves for player
+vector<point> Board::getValidMoves(int player) {
+	vector<point> validMoves;
+	getValidMoves(player, validMoves);
+	return validMoves;
+}
+
+// Retrieves all valid moves for player into validMoves (Reuses its memory)
+void Board::getValidMoves(int player, vector<point>& validMoves) {
+	validMoves.clear();
+	if (!useBitboard) {
+		for (int i = 0; i < width; i++) {
+			for (int j = 0; j < height; j++) {
+				if (isValidMove(player, i, j)) {
+					validMoves.push_back(point(i, j));
+				}
+			}
+		}
+		return;
+	}
+
+	uint64_t moves = getValidMovesMask(player);
+	while (moves) {
+		int index = __builtin_ctzll(moves);
+		moves &= moves - 1;
+		validMoves.push_back(point(index / height, index % height));
+	}
+}
+
+// Places Disk at (x, y) for player & flips opponent Disks. Assume move to be valid.
+void Board::makeMove(int player, int x, int y) {
+	MoveRecord record = {player, x, y, 0, 0, hash};
+	if (!useBitboard) {
+		record.numFlips = makeLargeMove(player, x, y);
+		history.push_back(record);
+		return;
+	}
+
+	uint64_t flips = getFlipsMask(player, x, y);
+	uint64_t move = 1ULL << (x * height + y);
+	if (player == BLACK) {
+		blackDisks |= flips | move;
+		whiteDisks &= ~flips;
+	} else {
+		whiteDisks |= flips | move;
+		blackDisks &= ~flips;
+	}
+	record.flips = flips;
+	history.push_back(record);
+
+	// Update hash with the new disk and the flipped disks
+	hash ^= ZOBRIST_KEYS[player][x * height + y];
+	while (flips) {
+		hash ^= ZOBRIST_FLIP_KEYS[__builtin_ctzll(flips)];
+		flips &= flips - 1;
+	}
+}
+
+// Takes back the last move made
+void Board::undoMove() {
+	MoveRecord record = history.back();
+	history.pop_back();
+	if (!useBitboard) {
+		for (int i = 0; i < record.numFlips; i++) {
+			flipDisk(largeFlips.back() / height, largeFlips.back() % height);
+			largeFlips.pop_back();
+		}
+		setDisk(EMPTY, record.x, record.y);
+		return;
+	}
+	hash = record.hash;
+
+	uint64_t move = 1ULL << (record.x * height + record.y);
+	if (record.player == BLACK) {
+		blackDisks &= ~(record.flips | move);
+		whiteDisks |= record.flips;
+	} else {
+		whiteDisks &= ~(record.flips | move);
+		blackDisks |= record.flips;
+	}
+}
+
+// Returns true if game is over (no more valid moves for both players)
+bool Board::isGameOver() {
+	if (!useBitboard) {
+		for (int i = 0; i < width; i++) {
+			for (int j = 0; j < height; j++) {
+				if (isValidMove(WHITE, i, j) || isValidMove(BLACK, i, j)) {
+					return false;
+				}
+			}
+		}
+		return true;
+	}
+	return getValidMovesMask(BLACK) == 0 && getValidMovesMask(WHITE) == 0;
+}
+
+/********************************** TRANSFER **********************************/
+
+// Number of bytes needed to pack the disks (4 cells per byte)
+int Board::getPackedSize() {
+	return (width * height + 3) / 4;
+}
+
+// Cell (x, y) is stored in bits 2 * (index % 4) of byte index / 4, where index = x * height + y
+void Board::pack(uint8_t* buffer) {
+	for (int i = 0; i < getPackedSize(); i++) {
+		buffer[i] = 0;
+	}
+	for (int x = 0; x < width; x++) {
+		for (int y = 0; y < height; y++) {
+			int index = x * height + y;
+			buffer[index / 4] |= getDisk(x, y) << (2 * (index % 4));
+		}
+	}
+}
+
+// Replaces the disks with those packed by pack (History of moves is cleared)
+void Board::unpack(const uint8_t* buffer) {
+	initBoard();
+	for (int x = 0; x < width; x++) {
+		for (int y = 0; y < height; y++) {
+			int index = x * height + y;
+			int disk = (buffer[index / 4] >> (2 * (index % 4))) & 3;
+			if (disk != EMPTY) {
+				setDisk(disk, x, y);
+			}
+		}
+	}
+}
+
+/******************** BOARDS LARGER THAN BITBOARD_MAX_CELLS *******************/
+
+bool Board::isValidLargeMove(int player, int x, int y) {
 	// Go through each direction and test if a Disk can be flipped
-	for (int d = 0; d < 8; d++) { 
+	for (int d = 0; d < 8; d++) {
 		int changeX = DIRECTION[d][0];
 		int changeY = DIRECTION[d][1];
 		int newX    = x + (2 * changeX);
 		int newY    = y + (2 * changeY);
 
 		// Disk along the direction has to be opponent's disk AND in board's range
-		if (!inRange(newX, newY) || data[x + changeX][y + changeY] != OPP(player)) {
+		if (!inRange(newX, newY) || getDisk(x + changeX, y + changeY) != OPP(player)) {
 			continue;
 		}
 		while (inRange(newX, newY)) {
 			// If there is your Disk, it means that you can place at current spot
-			if (data[newX][newY] == player) {
+			if (getDisk(newX, newY) == player) {
 				return true;
-			} 
+			}
 			// Cannot have Empty spots along the direction
-			if (data[newX][newY] == EMPTY) {
+			if (getDisk(newX, newY) == EMPTY) {
 				break;
 			}
 			newX = newX + changeX;
@@ -106,65 +409,45 @@ bool Board::isValidMove(int player, int x, int y) {
 	return false;
 }
 
-// Retrieves all valid moves for player
-vector<point> Board::getValidMoves(int player) {
-	vector<point> validMoves;
-	for (int i = 0; i < width; i++) {
-		for (int j = 0; j < height; j++) {
-			if (isValidMove(player, i, j)) {
-				point newPoint = point(i, j);
-				validMoves.push_back(newPoint);
-			}
-		}
-	}
-	return validMoves;
-}
+// Returns the number of Disks flipped (Flipped cells are pushed onto largeFlips)
+int Board::makeLargeMove(int player, int x, int y) {
+	int numFlips = 0;
 
-// Places Disk at (x, y) for player & flips opponent Disks. Assume move to be valid.
-void Board::makeMove(int player, int x, int y) {
 	// Go through each direction and test if a Disk can be flipped
-	for (int d = 0; d < 8; d++) { 
+	for (int d = 0; d < 8; d++) {
 		int changeX = DIRECTION[d][0];
 		int changeY = DIRECTION[d][1];
 		int newX    = x + (2 * changeX);
 		int newY    = y + (2 * changeY);
 
 		// Disk along the direction has to be opponent's disk AND in board's range
-		if (!inRange(newX, newY) || data[x + changeX][y + changeY] != OPP(player)) {
+		if (!inRange(newX, newY) || getDisk(x + changeX, y + changeY) != OPP(player)) {
 			continue;
 		}
 		while (inRange(newX, newY)) {
 			// If there is your Disk, reverse and flip the Disks that we've encountered
-			if (data[newX][newY] == player) {
+			if (getDisk(newX, newY) == player) {
 				newX -= changeX;
 				newY -= changeY;
 				while (newX != x || newY != y) {
 					flipDisk(newX, newY);
+					largeFlips.push_back(newX * height + newY);
+					numFlips++;
 					newX -= changeX;
 					newY -= changeY;
 				}
 				setDisk(player, x, y);
 				break;
-			} 
+			}
 			// Cannot have Empty spots along the direction
-			if (data[newX][newY] == EMPTY) {
+			if (getDisk(newX, newY) == EMPTY) {
 				break;
 			}
 			newX += changeX;
 			newY += changeY;
 		}
 	}
-}
-
-// Returns true if game is over (no more valid moves for both players)
-bool Board::isGameOver() {
-	bool moveExists = false;
-	for (int i = 0; i < width; i++) {
-		for (int j = 0; j < height; j++) {
-			moveExists = moveExists || isValidMove(WHITE, i, j) || isValidMove(BLACK, i, j);
-		}
-	}
-	return !moveExists;
+	return numFlips;
 }
 
 void Board::printBoard(int currentPlayer) {
@@ -181,18 +464,18 @@ void Board::printBoard(int currentPlayer) {
 		cout << leftMargin;
 		(j < 9) ? cout << (j + 1) << "  " : cout << (j + 1) << " ";
 		for (int i = 0; i < width; i++) {
-			if (data[i][j] == BLACK) {
+			if (getDisk(i, j) == BLACK) {
 				cout << "X";
-			} else if (data[i][j] == WHITE) {
+			} else if (getDisk(i, j) == WHITE) {
 				cout << "O";
 			} else if (isValidMove(currentPlayer, i, j)) {
 				cout << "?";
-			} else if (data[i][j] == EMPTY) {
+			} else if (getDisk(i, j) == EMPTY) {
 				cout << ".";
-			} 
+			}
 			cout << " ";
 		}
 		cout << endl;
 	}
 	cout << endl;
-}
\ No newline at end of file
+}
@@ -1,4 +1,5 @@
 #include <vector>
+#include <stdint.h>
 #include "config.h"
 #include "point.h"
 #include "disk.h"
@@ -8,33 +9,71 @@
 
 const int DIRECTION[8][2] = {{-1, -1}, {-1, 0}, {-1, 1}, {0, -1}, {0, 1}, {1, -1}, {1, 0}, {1, 1}};
 
+// Boards with at most this many cells are stored as bitboards (1 bit per cell per player)
+#define BITBOARD_MAX_CELLS 64
+
 using namespace std;
 
+// Information needed to undo a move
+typedef struct {
+	int player;
+	int x;
+	int y;
+	uint64_t flips;		// Flipped disks (Bitboard)
+	int numFlips;		// Number of flipped cells pushed onto largeFlips (Larger boards)
+	uint64_t hash;		// Hash before the move
+} MoveRecord;
+
+/*
+ * Boards of up to 64 cells (eg. 6x6 and 8x8) store their disks in 2 bitboards, one for each
+ * player. Cell (x, y) is bit (x * height + y), so that iterating over the bits from the
+ * lowest to the highest visits the cells in the same order as the (x, y) loops did.
+ * Larger boards fall back to storing 1 int per cell.
+ *
+ * Every move made is recorded so that it can be undone, which lets a search run on a single
+ * Board instead of copying the Board at every node.
+ *
+ * The Zobrist hash of the disks is updated along with every change to the Board.
+ */
 class Board {
 	public:
-		Board(int w, int h); 
-		Board(const Board &b);
-		
+		Board(int w, int h);
+
 		// Intialization
 		void initBoard();
 		void initBoard(vector<point> whiteStarting, vector<point> blackStarting);
-		
+
 		// Helpers
 		int getDisk(int x, int y);
 		void flipDisk(int x, int y);
 		void setDisk(int player, int x, int y);
 		bool inRange(int x, int y);
 		int getNumEmpty();
+		uint64_t getHash(int player);
 		int getWidth() { return width; };
 		int getHeight() { return height; };
+		bool isCorner(int x, int y);
+		bool isEdge(int x, int y);
+
+		// Counting (for evaluation of the board)
+		int countDisks(int player);
+		int countCornerDisks(int player);
+		int countEdgeDisks(int player);
 
 		// Moves
 		bool isValidMove(int player, int x, int y);
 		vector<point> getValidMoves(int player);
+		void getValidMoves(int player, vector<point>& validMoves);
 
 		void makeMove(int player, int x, int y);
+		void undoMove();
 		bool isGameOver();
 
+		// Transfer (2 bits per cell, so that Boards can be sent in a single message)
+		int getPackedSize();
+		void pack(uint8_t* buffer);
+		void unpack(const uint8_t* buffer);
+
 		// Debugging
 		void printBoard(int currentPlayer);
 
@@ -42,9 +81,36 @@ class Board {
 		// Configurations
 		int width;
 		int height;
+		bool useBitboard;
+
+		// Disks data (Bitboard)
+		uint64_t blackDisks;
+		uint64_t whiteDisks;
+		uint64_t hash;
+
+		// Masks of the bitboard (Shifts of each DIRECTION remove disks that wrap around)
+		uint64_t fullMask;
+		uint64_t cornerMask;
+		uint64_t edgeMask;
+		int directionShift[8];
+		uint64_t directionMask[8];
+
+		// Disks data (Boards larger than BITBOARD_MAX_CELLS)
+		vector<int> data;
+
+		// Moves made (For undoing moves)
+		vector<MoveRecord> history;
+		vector<int> largeFlips;
+
+		// Bitboard helpers
+		void initMasks();
+		uint64_t shiftDisks(uint64_t disks, int d);
+		uint64_t getValidMovesMask(int player);
+		uint64_t getFlipsMask(int player, int x, int y);
 
-		// Disks data
-		int** data;
+		// Helpers for boards larger than BITBOARD_MAX_CELLS
+		bool isValidLargeMove(int player, int x, int y);
+		int makeLargeMove(int player, int x, int y);
 };
 
-#endif
\ No newline at end of file
+#endif
@@ -2,7 +2,7 @@
 
 using namespace std;
 
-Config::Config(char* initialBoardFilename, char* paramsFilename) {
+Config::Config(char* initialBoardFilename, char* paramsFilename) : timeout(0), tableSize(0) {
 	ifstream initialBoardFile, paramsFile;
 	initialBoardFile.open(initialBoardFilename, ios::in);
 	paramsFile.open(paramsFilename, ios::in);
@@ -49,7 +49,9 @@ Config::Config(char* initialBoardFilename, char* paramsFilename) {
         	cornerValue = stoi(value);
         } else if (token.compare("EdgeValue") == 0) {
         	edgeValue = stoi(value);
-        } 
+        } else if (token.compare("TranspositionTableSize") == 0) {
+        	tableSize = stoi(value);
+        }
     }
 
     // Print Configurations
@@ -66,12 +68,13 @@ Config::Config(char* initialBoardFilename, char* paramsFilename) {
     }
     cout << endl;
     cout << "Color: " << ((getPlayer() == BLACK) ? "Black" : "White") << endl;
-    cout << "Timeout: " << getTimeout() << " (Not used)" << endl;
+    cout << "Timeout: " << getTimeout() << " s" << endl;
 
     cout << "MaxDepth: " << getMaxDepth() << endl;
     cout << "MaxBoards: " << getMaxBoards() << " (Not used)" << endl;
     cout << "CornerValue: " << getCornerValue() << endl;
     cout << "EdgeValue: " << getEdgeValue() << endl;
+    cout << "TranspositionTableSize: " << getTableSize() << " MB" << endl;
 }
 
 // Extract the points which are separated by commas
@@ -100,3 +103,4 @@ int Config::getMaxDepth() { return maxDepth; }
 int Config::getMaxBoards() { return maxBoards; }
 int Config::getCornerValue() { return cornerValue; }
 int Config::getEdgeValue() { return edgeValue; }
+int Config::getTableSize() { return tableSize; }
@@ -31,6 +31,7 @@ class Config {
 		int getMaxBoards();
 		int getCornerValue();
 		int getEdgeValue();
+		int getTableSize();
 
 	protected:
 		// Initial Board
@@ -46,6 +47,7 @@ class Config {
 		int maxBoards;
 		int cornerValue;
 		int edgeValue;
+		int tableSize;
 };
 
 #endif
\ No newline at end of file
@@ -1,5 +1,6 @@
 
 #include "job.h"
+#include "wire.h"
 
 // For timing purposes (From "mm-mpi.c")
 long long commTime = 0;
@@ -16,66 +17,464 @@ long long wallClockTime() {
 #endif
 }
 
+// Threads that execute Jobs (See setNumThreads). Thread 0 is the thread that uses MPI.
+int numThreads = 1;
+thread_local atomic<bool>* currentJobAborted = NULL;
+
+// Kept across all the Jobs that this process executes (See createTranspositionTable).
+// The table is lock-free, so it is shared by all the threads and processes of a node.
+TranspositionTable* transpositionTable = NULL;
+MPI_Win transpositionTableWin = MPI_WIN_NULL;
+TranspositionTable* getTranspositionTable(int tableSize) {
+	return (tableSize > 0) ? transpositionTable : NULL;
+}
+
+// Called by all processes at the start of the run. The first process of each node allocates the 
+// table in a shared memory window, and the other processes of the node use the same memory.
+void createTranspositionTable(int tableSize) {
+	if (tableSize <= 0) {
+		return;
+	}
+	MPI_Comm nodeComm;
+	MPI_Comm_split_type(MPI_COMM_WORLD, MPI_COMM_TYPE_SHARED, 0, MPI_INFO_NULL, &nodeComm);
+	int nodeId;
+	MPI_Comm_rank(nodeComm, &nodeId);
+
+	// 1 more bucket so that the buckets can be aligned to cache lines (The window may not be)
+	long long numBuckets = TranspositionTable::getNumBuckets(tableSize);
+	MPI_Aint size = (nodeId == 0) ? (numBuckets + 1) * sizeof(TTBucket) : 0;
+	void* memory;
+	MPI_Win_allocate_shared(size, 1, MPI_INFO_NULL, nodeComm, &memory, &transpositionTableWin);
+	if (nodeId != 0) {
+		int dispUnit;
+		MPI_Win_shared_query(transpositionTableWin, 0, &size, &dispUnit, &memory);
+	}
+	uintptr_t aligned = ((uintptr_t) memory + sizeof(TTBucket) - 1) & ~(uintptr_t) (sizeof(TTBucket) - 1);
+
+	transpositionTable = new TranspositionTable((TTBucket*) aligned, numBuckets);
+	if (nodeId == 0) {
+		transpositionTable->clear();
+	}
+	MPI_Barrier(nodeComm);
+	MPI_Comm_free(&nodeComm);
+}
+
+// Called by all processes at the end of the run
+void freeTranspositionTable() {
+	if (transpositionTable == NULL) {
+		return;
+	}
+	delete transpositionTable;
+	transpositionTable = NULL;
+	MPI_Win_free(&transpositionTableWin);
+}
+
+// Positions searched by other processes (See createDistributedTable)
+DistributedTable distributedTable = {MPI_WIN_NULL, NULL, 0, 0, 0, vector<TTSlot>(), 
+	vector<MPI_Request>(), vector<TTSlot>(), vector<uint64_t>(), vector<int>(), vector<int>()};
+thread::id mpiThread = this_thread::get_id();
+
+// Called by all processes at the start of the run (minDepth of 0 disables the table). Each
+// process keeps tableSize MB of the table, which the others read and write with atomic
+// one-sided operations.
+void createDistributedTable(int tableSize, int minDepth) {
+	if (tableSize <= 0 || minDepth <= 0) {
+		return;
+	}
+	DistributedTable* dt = &distributedTable;
+	MPI_Comm_size(MPI_COMM_WORLD, &dt->numProcs);
+	dt->minDepth = minDepth;
+	dt->numSlots = TranspositionTable::getNumBuckets(tableSize) * TT_BUCKET_SIZE;
+	dt->pendingStores.reserve(DISTRIBUTED_TABLE_BATCH_SIZE);
+	dt->probeRequests.assign(DISTRIBUTED_TABLE_BATCH_SIZE, MPI_REQUEST_NULL);
+	dt->probeResults.resize(DISTRIBUTED_TABLE_BATCH_SIZE);
+	dt->probeKeys.resize(DISTRIBUTED_TABLE_BATCH_SIZE);
+	dt->completedProbes.resize(DISTRIBUTED_TABLE_BATCH_SIZE);
+	for (int i = DISTRIBUTED_TABLE_BATCH_SIZE - 1; i >= 0; i--) {
+		dt->freeProbes.push_back(i);
+	}
+	MPI_Win_allocate(dt->numSlots * sizeof(TTSlot), sizeof(TTSlot), MPI_INFO_NULL, MPI_COMM_WORLD, 
+		&dt->slots, &dt->win);
+
+	TTEntry empty = {0, 0, -1, 0, TT_EMPTY};
+	uint64_t data = TranspositionTable::packEntry(&empty);
+	for (long long i = 0; i < dt->numSlots; i++) {
+		dt->slots[i].check = data;
+		dt->slots[i].data = data;
+	}
+	MPI_Win_lock_all(0, dt->win);
+	MPI_Win_sync(dt->win);
+	MPI_Barrier(MPI_COMM_WORLD);
+}
+
+// Called by all processes at the end of the run
+void freeDistributedTable() {
+	if (distributedTable.win == MPI_WIN_NULL) {
+		return;
+	}
+	flushDistributedTable();
+	MPI_Waitall(DISTRIBUTED_TABLE_BATCH_SIZE, distributedTable.probeRequests.data(), MPI_STATUSES_IGNORE);
+	MPI_Win_unlock_all(distributedTable.win);
+	MPI_Win_free(&distributedTable.win);
+}
+
+// Process that keeps the position and the index of its slot there (1 slot per index)
+void getDistributedSlot(uint64_t key, int* owner, MPI_Aint* slot) {
+	*owner = (key >> 32) % distributedTable.numProcs;
+	*slot = key & (distributedTable.numSlots - 1);
+}
+
+// Returns true if positions with this depth left are kept in the distributed table by this thread
+bool usesDistributedTable(int depth) {
+	DistributedTable* dt = &distributedTable;
+	return dt->win != MPI_WIN_NULL && depth >= dt->minDepth && this_thread::get_id() == mpiThread;
+}
+
+// Starts reading the slot of the position from the process that keeps it without waiting for it
+// (See receiveDistributedTable). The read is dropped if too many reads are in progress.
+void prefetchDistributedTable(uint64_t key, int depth) {
+	DistributedTable* dt = &distributedTable;
+	if (!usesDistributedTable(depth) || dt->freeProbes.size() == 0) {
+		return;
+	}
+	int owner;
+	MPI_Aint slot;
+	getDistributedSlot(key, &owner, &slot);
+
+	int probe = dt->freeProbes.back();
+	dt->freeProbes.pop_back();
+	dt->probeKeys[probe] = key;
+	MPI_Rget_accumulate(NULL, 0, MPI_UINT64_T, &dt->probeResults[probe], 2, MPI_UINT64_T, owner, slot, 
+		2, MPI_UINT64_T, MPI_NO_OP, dt->win, &dt->probeRequests[probe]);
+}
+
+// Copies the reads that have completed into the table of the process. Reads that have not 
+// completed are left for a later call, so this never waits for another process.
+void receiveDistributedTable(TranspositionTable* table, int depth) {
+	DistributedTable* dt = &distributedTable;
+	if (!usesDistributedTable(depth) || dt->freeProbes.size() == DISTRIBUTED_TABLE_BATCH_SIZE) {
+		return;
+	}
+	int numCompleted;
+	MPI_Testsome(DISTRIBUTED_TABLE_BATCH_SIZE, dt->probeRequests.data(), &numCompleted, 
+		dt->completedProbes.data(), MPI_STATUSES_IGNORE);
+	for (int i = 0; i < numCompleted; i++) {
+		int probe = dt->completedProbes[i];
+		dt->freeProbes.push_back(probe);
+
+		// The 2 words are written separately, so a slot being written fails the check
+		uint64_t key = dt->probeKeys[probe];
+		TTSlot* result = &dt->probeResults[probe];
+		if ((result->check ^ result->data) != key) {
+			continue;
+		}
+		TTEntry entry;
+		TranspositionTable::unpackEntry(result->data, &entry);
+		if (entry.flags == TT_EMPTY) {
+			continue;
+		}
+
+		// Entries of this process that are deeper are kept
+		TTEntry local;
+		if (!table->probe(key, &local) || local.depth < entry.depth) {
+			table->store(key, entry.depth, TranspositionTable::getBound(&entry), entry.value, entry.bestMove);
+		}
+	}
+}
+
+// Writes the slot of the position in the process that keeps it without waiting for it. The 
+// writes are completed together once DISTRIBUTED_TABLE_BATCH_SIZE of them have been sent.
+void storeDistributedTable(uint64_t key, int depth, int bound, int value, int bestMove) {
+	DistributedTable* dt = &distributedTable;
+	if (!usesDistributedTable(depth)) {
+		return;
+	}
+	int owner;
+	MPI_Aint slot;
+	getDistributedSlot(key, &owner, &slot);
+
+	TTEntry entry = {key, value, (int16_t) bestMove, (uint8_t) min(depth, 0xFF), (uint8_t) bound};
+	uint64_t data = TranspositionTable::packEntry(&entry);
+	TTSlot stored = {key ^ data, data};
+	dt->pendingStores.push_back(stored);
+	MPI_Accumulate(&dt->pendingStores.back(), 2, MPI_UINT64_T, owner, slot, 2, MPI_UINT64_T, 
+		MPI_REPLACE, dt->win);
+
+	if (dt->pendingStores.size() == DISTRIBUTED_TABLE_BATCH_SIZE) {
+		flushDistributedTable();
+	}
+}
+
+// Completes the writes that were sent (Also called once the Jobs of the process are done)
+void flushDistributedTable() {
+	DistributedTable* dt = &distributedTable;
+	if (dt->win == MPI_WIN_NULL || dt->pendingStores.size() == 0) {
+		return;
+	}
+	long long before = wallClockTime();
+	MPI_Win_flush_all(dt->win);
+	commTime += wallClockTime() - before;
+	dt->pendingStores.clear();
+}
+
+// Search parameters sent by Master at the start of the run (Master keeps them to read stolen Jobs)
+Session session;
+
+// Search round that the Job pool is in, so that Slaves ignore aborts meant for earlier rounds
+int searchRound = 0;
+vector<int> abortedJobs;
+
+// Job pool that Master is serving while it works on a Job itself (NULL otherwise)
+JobPool* masterJobPool = NULL;
+
+// Processes that Master and Slaves talk to, Master is process 0 (See joinGroups)
+MPI_Comm jobComm = MPI_COMM_WORLD;
+MPI_Comm topComm = MPI_COMM_NULL;
+MPI_Comm groupComm = MPI_COMM_NULL;
+
+// Jobs that this process shares with the others while it works on a Job (NULL otherwise)
+WorkStealing* workStealing = NULL;
+unsigned int stealSeed = 0;
+
+// Chooses the Jobs of the RANDOM distribution (See setRandomSeed)
+mt19937 jobRandom;
+
+// Jobs per processor that a Job pool keeps before they are sent (See masterGenerateJobs)
+int jobFrontierPerProc = 0;
+
 /******************************* JOB EXECUTION *******************************/
 
 // Compute the minimax of each move of the board in a Job
-CompletedJob executeMinimaxJob(Job* job) {
+CompletedJob executeMinimaxJob(Job* job, long long deadline, bool abortable) {
 	Solver solver = Solver(job->width, job->height, job->depthLeft, 
 		job->maxBoards, job->cornerValue, job->edgeValue);
+	solver.setDeadline(deadline);
+	solver.setAbortableJob(abortable ? job->id : -1);
 	int player = job->player;
 	int depth = job->depthLeft;
 	Board* currentBoard = job->board;
 	int value = (player == BLACK) ? solver.getMaxValue(*currentBoard, player, depth) :
 									solver.getMinValue(*currentBoard, player, depth);
-	CompletedJob cj = {job->id, job->parentId, player, value, solver.getBoardsSearched()};
+	CompletedJob cj = {job->id, job->parentId, player, value, solver.getBoardsSearched(), 0, 0};
 	return cj;
 }
 
 // Compute the minimax of each move of the board in a Job with alpha-beta pruning
-CompletedJob executeAlphaBetaJob(Job* job) {
+CompletedJob executeAlphaBetaJob(Job* job, long long deadline, bool abortable) {
 	Solver solver = Solver(job->width, job->height, job->depthLeft, 
 		job->maxBoards, job->cornerValue, job->edgeValue);
+	solver.setDeadline(deadline);
+	solver.setAbortableJob(abortable ? job->id : -1);
+	solver.setTranspositionTable(getTranspositionTable(job->tableSize));
 	int player = job->player;
 	int depth = job->depthLeft;
 	Board* currentBoard = job->board;
-	int value = (player == BLACK) ? solver.getAlphaBetaMaxValue(INT_MIN, INT_MAX, *currentBoard, player, depth) :
-									solver.getAlphaBetaMinValue(INT_MIN, INT_MAX, *currentBoard, player, depth);
-	CompletedJob cj = {job->id, job->parentId, player, value, solver.getBoardsSearched()};
+	int value = (player == BLACK) ? solver.getAlphaBetaMaxValue(job->alpha, job->beta, *currentBoard, player, depth) :
+									solver.getAlphaBetaMinValue(job->alpha, job->beta, *currentBoard, player, depth);
+	CompletedJob cj = {job->id, job->parentId, player, value, solver.getBoardsSearched(), 0, 0};
 	return cj;
 }
 
-vector<CompletedJob> executeAllJobs(string algorithm, vector<Job> job) {
+// Compute the minimax of each move of the board in a Job with principal variation search
+CompletedJob executePVSJob(Job* job, long long deadline, bool abortable) {
+	Solver solver = Solver(job->width, job->height, job->depthLeft, 
+		job->maxBoards, job->cornerValue, job->edgeValue);
+	solver.setDeadline(deadline);
+	solver.setAbortableJob(abortable ? job->id : -1);
+	solver.setTranspositionTable(getTranspositionTable(job->tableSize));
+	int player = job->player;
+	int depth = job->depthLeft;
+	Board* currentBoard = job->board;
+	int alpha = max(job->alpha, -INT_MAX);
+	int value = (player == BLACK) ? solver.getPVSValue(alpha, job->beta, *currentBoard, player, depth) :
+									-solver.getPVSValue(-job->beta, -alpha, *currentBoard, player, depth);
+	CompletedJob cj = {job->id, job->parentId, player, value, solver.getBoardsSearched(), 0, 0};
+	return cj;
+}
+
+// Jobs that are abortable stop as soon as Master aborts them (Their results are ignored)
+vector<CompletedJob> executeAllJobs(string algorithm, vector<Job> job, bool abortable) {
 	vector<CompletedJob> completedJobs;
+	if (job.size() == 0) {
+		return completedJobs;
+	}
 
-	if (algorithm.compare("BATCH_MINIMAX") == 0 || 
-		algorithm.compare("JOBPOOL_MINIMAX") == 0) {
+	// All Jobs were sent together, so they share the same deadline
+	long long deadline = (job[0].timeLimit > 0) ? wallClockTime() + job[0].timeLimit : 0;
 
-		for (int i = 0; i < job.size(); i++) {
-			CompletedJob cj = executeMinimaxJob(&job[i]);
-			completedJobs.push_back(cj);
+	// Jobs that were aborted while waiting are not searched at all
+	if (abortable) {
+		for (int i = job.size() - 1; i >= 0; i--) {
+			if (isJobAborted(job[i].id)) {
+				CompletedJob cj = {job[i].id, job[i].parentId, job[i].player, 0, 0, 0, 0};
+				completedJobs.push_back(cj);
+				job.erase(job.begin() + i);
+			}
 		}
+	}
+
+	if (numThreads > 1 && job.size() > 1) {
+		vector<CompletedJob> threadedJobs = executeJobsInThreads(algorithm, &job, deadline, abortable);
+		completedJobs.insert(completedJobs.end(), threadedJobs.begin(), threadedJobs.end());
+		return completedJobs;
+	}
+
+	for (int i = 0; i < job.size(); i++) {
+		completedJobs.push_back(executeJob(algorithm, &job[i], deadline, abortable));
+	}
+	flushDistributedTable();
+	return completedJobs;
+}
+
+CompletedJob executeJob(string algorithm, Job* job, long long deadline, bool abortable) {
+	if (algorithm.compare("BATCH_MINIMAX") == 0 || 
+		algorithm.compare("JOBPOOL_MINIMAX") == 0 ||
+		algorithm.compare("STEALING_MINIMAX") == 0 ||
+		algorithm.compare("HIERARCHICAL_MINIMAX") == 0 ||
+		algorithm.compare("RMA_MINIMAX") == 0) {
+		return executeMinimaxJob(job, deadline, abortable);
 
 	} else if (algorithm.compare("BATCH_ALPHABETA") == 0 ||
-	   algorithm.compare("JOBPOOL_ALPHABETA") == 0) {
+	   algorithm.compare("JOBPOOL_ALPHABETA") == 0 ||
+	   algorithm.compare("YBWC_ALPHABETA") == 0 ||
+	   algorithm.compare("STEALING_ALPHABETA") == 0 ||
+	   algorithm.compare("HIERARCHICAL_ALPHABETA") == 0 ||
+	   algorithm.compare("RMA_ALPHABETA") == 0) {
+		return executeAlphaBetaJob(job, deadline, abortable);
+
+	} else if (algorithm.compare("BATCH_PVS") == 0 ||
+	   algorithm.compare("JOBPOOL_PVS") == 0 ||
+	   algorithm.compare("STEALING_PVS") == 0 ||
+	   algorithm.compare("HIERARCHICAL_PVS") == 0 ||
+	   algorithm.compare("RMA_PVS") == 0) {
+		return executePVSJob(job, deadline, abortable);
+	}
+	CompletedJob cj = {job->id, job->parentId, job->player, 0, 0, 0, 0};
+	return cj;
+}
+
+/********************************** THREADS **********************************/
+
+// Jobs of a process are executed by this many threads (1 to execute them one by one)
+void setNumThreads(int threads) {
+	numThreads = max(1, threads);
+}
+
+int getNumThreads() {
+	return numThreads;
+}
 
-		for (int i = 0; i < job.size(); i++) {
-			CompletedJob cj = executeAlphaBetaJob(&job[i]);
-			completedJobs.push_back(cj);
+// Worker threads take the next Job until there are none left. Only the thread that called 
+// executeAllJobs uses MPI (MPI_THREAD_FUNNELED): It checks if the running Jobs are aborted, and 
+// the searches of the worker threads read the result (See isJobAborted).
+vector<CompletedJob> executeJobsInThreads(string algorithm, vector<Job>* jobs, long long deadline, 
+	bool abortable) {
+	int numJobs = jobs->size();
+	vector<CompletedJob> completedJobs(numJobs);
+	atomic<bool>* aborted = new atomic<bool>[numJobs];
+	for (int i = 0; i < numJobs; i++) {
+		aborted[i] = false;
+	}
+	ThreadedJobs threadedJobs = {algorithm, jobs, &completedJobs, aborted, deadline, abortable, {0}, {0}};
+
+	vector<thread> workers;
+	for (int t = 0; t < min(numThreads, numJobs); t++) {
+		workers.push_back(thread(executeJobsInThread, &threadedJobs));
+	}
+	while (abortable && threadedJobs.jobsDone < numJobs) {
+		for (int i = 0; i < numJobs; i++) {
+			if (!aborted[i] && isJobAborted((*jobs)[i].id)) {
+				aborted[i] = true;
+			}
 		}
+		this_thread::sleep_for(chrono::milliseconds(1));
+	}
+	for (int t = 0; t < workers.size(); t++) {
+		workers[t].join();
 	}
+
+	delete[] aborted;
 	return completedJobs;
 }
 
+void executeJobsInThread(ThreadedJobs* threadedJobs) {
+	int numJobs = threadedJobs->jobs->size();
+	for (int i = threadedJobs->nextJob++; i < numJobs; i = threadedJobs->nextJob++) {
+		currentJobAborted = &threadedJobs->aborted[i];
+		(*threadedJobs->completedJobs)[i] = executeJob(threadedJobs->algorithm, &(*threadedJobs->jobs)[i], 
+			threadedJobs->deadline, threadedJobs->abortable);
+		currentJobAborted = NULL;
+		threadedJobs->jobsDone++;
+	}
+}
+
 /********************************** GENERAL **********************************/
 
+// Time left (ns) before the deadline, 0 if there is no deadline
+long long getTimeLimit(long long deadline) {
+	if (deadline == 0) {
+		return 0;
+	}
+	return max(1LL, deadline - wallClockTime());
+}
+
+// Send a message (See wire.h) to a process
+void sendMessage(vector<uint8_t>* message, int id, int tag, MPI_Comm comm) {
+	MPI_Send((void*)message->data(), message->size(), MPI_BYTE, id, tag, comm);
+}
+
+// Receive a message (See wire.h) from a process (or MPI_ANY_SOURCE), returns the sender
+int receiveMessage(vector<uint8_t>* message, int id, int tag, MPI_Comm comm) {
+	MPI_Status status;
+	MPI_Probe(id, tag, comm, &status);
+
+	// Resize buffer based on how much data is being received
+	int incomingSize;
+	MPI_Get_count(&status, MPI_BYTE, &incomingSize);
+	message->resize(incomingSize);
+	MPI_Recv((void*)message->data(), incomingSize, MPI_BYTE, status.MPI_SOURCE, tag, comm,
+		MPI_STATUS_IGNORE);
+	return status.MPI_SOURCE;
+}
+
+// Processes cannot continue after receiving a message they do not understand
+void abortOnBadMessage(bool ok) {
+	if (!ok) {
+		printf("--- ERROR: Message could not be read ---\n");
+		MPI_Abort(MPI_COMM_WORLD, 1);
+	}
+}
+
+// Search parameters are sent once, instead of with every Job
+void masterSendSession(int numProcs, int width, int height, int maxBoards, int cornerValue, int edgeValue,
+	int tableSize) {
+	Session masterSession = {width, height, maxBoards, cornerValue, edgeValue, tableSize};
+	session = masterSession;
+	vector<uint8_t> message;
+	packSession(&message, &session);
+	for (int i = 1; i < numProcs; i++) {
+		sendMessage(&message, i, 0, jobComm);
+	}
+}
+
+void slaveReceiveSession() {
+	vector<uint8_t> message;
+	receiveMessage(&message, 0, 0, jobComm);
+	abortOnBadMessage(unpackSession(&message, &session));
+}
+
 void masterNotifySlaves(int numProcs, int action) {
+	if (action == MASTER_SENDING_JOBS) {
+		searchRound++;
+	}
 	for (int i = 1; i < numProcs; i++) {
-		MPI_Send(&action, 1, MPI_INT, i, 0, MPI_COMM_WORLD);
+		MPI_Send(&action, 1, MPI_INT, i, 0, jobComm);
 	}
 }
 
 void masterInitialiseJobs(deque<Job>* jobs, deque<Board>* boards, deque<CompletedJob>* waitingJobs, 
-	vector<point> validMoves, Board board, int player, int depth, int maxBoards, int cornerValue, int edgeValue) {
+	vector<point> validMoves, Board board, int player, int depth, int maxBoards, int cornerValue, int edgeValue,
+	int tableSize) {
 	int width = board.getWidth();
 	int height = board.getHeight();
 	for (int i = 0; i < validMoves.size(); i++) {
@@ -84,95 +483,285 @@ void masterInitialiseJobs(deque<Job>* jobs, deque<Board>* boards, deque<Complete
 
 		// Setup jobs. parentId = -1 since they are the original moves
 		Job newJob = {
-			i, -1, width, height, maxBoards, cornerValue, edgeValue, 
-			OPP(player), depth - 1, 0, &newBoard
+			i, -1, width, height, maxBoards, cornerValue, edgeValue, tableSize,
+			OPP(player), depth - 1, 0, INT_MIN, INT_MAX, 0, &newBoard, 0
 		};
 		jobs->push_back(newJob);
 		boards->push_back(newBoard);
 
 		// Setup waiting jobs to combine results when Slaves are done
 		CompletedJob waitingJob = {
-			i, -1, OPP(player), ((OPP(player) == BLACK) ? INT_MIN : INT_MAX), 0
+			i, -1, OPP(player), ((OPP(player) == BLACK) ? INT_MIN : INT_MAX), 0, 0, 0
 		};
 		waitingJobs->push_back(waitingJob);
 	}
 }
 
-// Given a current Job, split into multiple Jobs by taking the first valid move in the board.
+// Estimated number of boards that searching the Job assesses: The boards of a search of 2 moves
+// give the number of moves per depth, which is raised to the depth left
+double estimateJobCost(Job* job, Board* board) {
+	if (board->isGameOver()) {
+		return 0;
+	}
+	int player = job->player;
+	vector<point> validMoves = board->getValidMoves(player);
+	if (validMoves.size() == 0) {
+		player = OPP(player);
+		validMoves = board->getValidMoves(player);
+	}
+
+	int numBoards = 0;
+	for (int i = 0; i < validMoves.size(); i++) {
+		Board newBoard = *board;
+		newBoard.makeMove(player, validMoves[i].x, validMoves[i].y);
+		numBoards += max(1, (int) newBoard.getValidMoves(OPP(player)).size());
+	}
+	int depth = min(job->depthLeft, board->getNumEmpty());
+	return pow(max(1.0, sqrt((double) numBoards)), depth);
+}
+
+// Split the most expensive Jobs (See estimateJobCost) by taking each valid move in their boards,
+// until there are the desired Jobs per processor and no Job is more than the share of a processor.
 // Parent jobs are stored in waitingJobs so that they can be recombined when Slaves are done.
 void splitJobs(deque<Job>* jobs, deque<Board>* boards, deque<CompletedJob>* waitingJobs, 
 	int numProcs, int jobsPerProc) {
 
 	// To prevent too many jobs from being created
-	jobsPerProc = min(100, jobsPerProc);
-	int jobId = jobs->size();
-
-	// Split current Jobs into more Jobs until we reach desired Jobs per processor
-	while (jobs->size() < numProcs * jobsPerProc) {
-		// Get next Job
-		Job currentJob = jobs->front();
-		Board currentBoard = boards->front();
-		jobs->pop_front();
-		boards->pop_front();
+	jobsPerProc = min(MAX_JOBS_PER_PROC, jobsPerProc);
+	int maxJobs = numProcs * MAX_JOBS_PER_PROC;
 
-		Solver solver = Solver(currentJob.width, currentJob.height, currentJob.depthLeft, 
-			currentJob.maxBoards, currentJob.cornerValue, currentJob.edgeValue);
+	double totalCost = 0;
+	for (int i = 0; i < jobs->size(); i++) {
+		(*jobs)[i].cost = estimateJobCost(&(*jobs)[i], &(*boards)[i]);
+		totalCost += (*jobs)[i].cost;
+	}
 
-		// Do not send if the current board is over
-		if (currentBoard.isGameOver()) {
-			CompletedJob waitingJob = { 
-				currentJob.id, currentJob.parentId, currentJob.player,
-				solver.evaluateBoard(currentBoard), 
-				currentJob.boardsAssessed + 1 
-			};
-			waitingJobs->push_back(waitingJob);
+	while (jobs->size() > 0) {
+		// Jobs at the last depth cannot be split (Happens in shallow searches)
+		int next = getMostExpensiveJob(jobs);
+		if (next < 0) {
+			break;
+		}
+		if (jobs->size() >= numProcs * jobsPerProc && 
+			((*jobs)[next].cost <= totalCost / numProcs || jobs->size() >= maxJobs)) {
+			break;
+		}
 
-			jobId++;
-			continue;
+		// Split most expensive Job
+		totalCost -= (*jobs)[next].cost;
+		int numNewJobs = splitJob(jobs, boards, waitingJobs, next);
+		for (int i = jobs->size() - numNewJobs; i < jobs->size(); i++) {
+			totalCost += (*jobs)[i].cost;
 		}
-		vector<point> validMoves = currentBoard.getValidMoves(currentJob.player);
-		
-		for (int i = 0; i < validMoves.size(); i++) {
-			Board newBoard = currentBoard;
-			point move = validMoves[i];
-			newBoard.makeMove(currentJob.player, move.x, move.y);
+	}
+}
+
+// Index of the Job with the highest cost that can be split, -1 if there is none
+int getMostExpensiveJob(deque<Job>* jobs) {
+	int next = -1;
+	for (int i = 0; i < jobs->size(); i++) {
+		if ((*jobs)[i].depthLeft > 0 && (next < 0 || (*jobs)[i].cost > (*jobs)[next].cost)) {
+			next = i;
+		}
+	}
+	return next;
+}
+
+// Job pools split Jobs as Slaves ask for them, keeping at most this many Jobs per processor that
+// have not been sent (0 to split every Job before the pool starts)
+void setJobFrontier(int jobsPerProc) {
+	jobFrontierPerProc = max(0, jobsPerProc);
+}
+
+// Jobs per processor that a Job pool splits into before it starts
+int getInitialJobsPerProc(int numJobsPerProc) {
+	return (jobFrontierPerProc > 0) ? min(numJobsPerProc, jobFrontierPerProc) : numJobsPerProc;
+}
 
-			// Package into Job and send it back into Job queue
-			Job newJob = {
-				jobId, currentJob.id, currentJob.width, currentJob.height, 
-				currentJob.maxBoards, currentJob.cornerValue, currentJob.edgeValue,
-				OPP(currentJob.player), currentJob.depthLeft - 1, 
-				currentJob.boardsAssessed + 1, &newBoard
-			};
-			jobs->push_back(newJob);
-			boards->push_back(newBoard);
+// Lazy Job generation: While the pool has fewer Jobs than the frontier, its most expensive Job is
+// split, until numJobsPerProc Jobs per processor have been generated. Only the frontier has 
+// Boards, and the costs of the Jobs are kept with them, so this does not search any board again.
+void masterGenerateJobs(JobPool* pool) {
+	if (jobFrontierPerProc <= 0) {
+		return;
+	}
+	deque<Job>* jobs = pool->jobs;
+	deque<Board>* boards = pool->boards;
+	deque<CompletedJob>* waitingJobs = pool->waitingJobs;
+	int frontier = pool->numProcs * jobFrontierPerProc;
+	int maxJobs = pool->numProcs * min(MAX_JOBS_PER_PROC, pool->numJobsPerProc);
+	bool sorted = (pool->jobDistribution.compare("LONGEST_FIRST") == 0);
+
+	while (jobs->size() > 0 && jobs->size() < frontier && waitingJobs->size() < maxJobs) {
+		int next = getMostExpensiveJob(jobs);
+		if (next < 0) {
+			break;
+		}
 
-			// Update waiting Jobs
-			CompletedJob waitingJob = { 
-				jobId, currentJob.id, OPP(currentJob.player),
-				((OPP(currentJob.player) == BLACK) ? INT_MIN : INT_MAX), 
-				currentJob.boardsAssessed + 1 
-			};
-			waitingJobs->push_back(waitingJob);
+		// The split Job now waits for its new Jobs (See masterInitialiseJobsLeft)
+		int id = (*jobs)[next].id;
+		int numNewJobs = splitJob(jobs, boards, waitingJobs, next);
+		(*waitingJobs)[id].jobsLeft = numNewJobs;
+		for (int i = waitingJobs->size() - numNewJobs; i < waitingJobs->size(); i++) {
+			(*waitingJobs)[i].jobsLeft = 1;
+		}
+		if (numNewJobs == 0) {
+			masterPropagateValue(waitingJobs, id);
+		}
 
-			jobId++;
+		// LONGEST_FIRST pools stay sorted (See masterOrderJobs), so the new Jobs are moved to their place
+		for (int i = jobs->size() - numNewJobs; sorted && i < jobs->size(); i++) {
+			Job job = (*jobs)[i];
+			Board board = (*boards)[i];
+			int place = i;
+			while (place > 0 && (*jobs)[place - 1].cost < job.cost) {
+				place--;
+			}
+			jobs->erase(jobs->begin() + i);
+			boards->erase(boards->begin() + i);
+			jobs->insert(jobs->begin() + place, job);
+			boards->insert(boards->begin() + place, board);
 		}
 	}
 }
 
-void masterSendBatchJobs(deque<Job>* jobs, deque<Board>* boards, int numProcs, string jobDistribution) {
+// Replace the Job at the index of the queue by a Job for each valid move of its board (added at 
+// the back of the queue), and returns the number of new Jobs
+int splitJob(deque<Job>* jobs, deque<Board>* boards, deque<CompletedJob>* waitingJobs, int index) {
+	int jobId = waitingJobs->size();
+	Job currentJob = (*jobs)[index];
+	Board currentBoard = (*boards)[index];
+
+	// Taken out in constant time: From the front, or swapped with the last Job
+	if (index == 0) {
+		jobs->pop_front();
+		boards->pop_front();
+	} else {
+		swap((*jobs)[index], jobs->back());
+		swap((*boards)[index], boards->back());
+		jobs->pop_back();
+		boards->pop_back();
+	}
+
+	Solver solver = Solver(currentJob.width, currentJob.height, currentJob.depthLeft, 
+		currentJob.maxBoards, currentJob.cornerValue, currentJob.edgeValue);
+
+	// Do not send if the current board is over (Its waiting Job already exists)
+	if (currentBoard.isGameOver()) {
+		(*waitingJobs)[currentJob.id].moveValue = solver.evaluateBoard(currentBoard);
+		return 0;
+	}
+	vector<point> validMoves = currentBoard.getValidMoves(currentJob.player);
+
+	// Skip to next player if no moves (Same board and depth)
+	if (validMoves.size() == 0) {
+		Job newJob = currentJob;
+		newJob.id = jobId;
+		newJob.parentId = currentJob.id;
+		newJob.player = OPP(currentJob.player);
+		jobs->push_back(newJob);
+		boards->push_back(currentBoard);
+
+		CompletedJob waitingJob = { 
+			jobId, currentJob.id, OPP(currentJob.player),
+			((OPP(currentJob.player) == BLACK) ? INT_MIN : INT_MAX), 
+			currentJob.boardsAssessed, 0, 0
+		};
+		waitingJobs->push_back(waitingJob);
+		return 1;
+	}
+
+	for (int i = 0; i < validMoves.size(); i++) {
+		Board newBoard = currentBoard;
+		point move = validMoves[i];
+		newBoard.makeMove(currentJob.player, move.x, move.y);
+
+		// Package into Job and send it back into Job queue
+		Job newJob = {
+			jobId, currentJob.id, currentJob.width, currentJob.height, 
+			currentJob.maxBoards, currentJob.cornerValue, currentJob.edgeValue, currentJob.tableSize,
+			OPP(currentJob.player), currentJob.depthLeft - 1, 
+			currentJob.boardsAssessed + 1, currentJob.alpha, currentJob.beta, 0, &newBoard, 0
+		};
+		newJob.cost = estimateJobCost(&newJob, &newBoard);
+		jobs->push_back(newJob);
+		boards->push_back(newBoard);
+
+		// Update waiting Jobs
+		CompletedJob waitingJob = { 
+			jobId, currentJob.id, OPP(currentJob.player),
+			((OPP(currentJob.player) == BLACK) ? INT_MIN : INT_MAX), 
+			currentJob.boardsAssessed + 1, 0, 0
+		};
+		waitingJobs->push_back(waitingJob);
+
+		jobId++;
+	}
+	return validMoves.size();
+}
+
+void masterSendBatchJobs(deque<Job>* jobs, deque<Board>* boards, int numProcs, string jobDistribution,
+	long long deadline) {
+	if (jobDistribution.compare("LONGEST_FIRST") == 0) {
+		masterSendLongestFirstJobs(jobs, boards, numProcs, deadline);
+		return;
+	}
+
 	int numJobs = jobs->size();
-	int jobsAllocated = 0;
 	for (int i = 1; i < numProcs; i++) {
 		int problemSize = floor(numJobs * (i + 1) / numProcs) - floor(numJobs * i / numProcs);
 		printf("For Processor %d, Problem size: %d\n", i, problemSize);
 
-		masterSendJobs(jobs, boards, i, problemSize, jobDistribution);
+		masterSendJobs(jobs, boards, i, problemSize, jobDistribution, deadline, NULL);
 	}
 }
 
+// Jobs are taken from the most expensive (See masterOrderJobs), and each goes to the processor 
+// with the least estimated work so far. Master keeps its Jobs in the queue.
+void masterSendLongestFirstJobs(deque<Job>* jobs, deque<Board>* boards, int numProcs, long long deadline) {
+	vector<vector<Job> > jobsOfProc(numProcs);
+	vector<vector<Board> > boardsOfProc(numProcs);
+	priority_queue<pair<double, int>, vector<pair<double, int> >, greater<pair<double, int> > > work;
+	for (int i = 0; i < numProcs; i++) {
+		work.push(make_pair(0.0, i));
+	}
+	for (int k = 0; k < jobs->size(); k++) {
+		pair<double, int> proc = work.top();
+		work.pop();
+		jobsOfProc[proc.second].push_back((*jobs)[k]);
+		boardsOfProc[proc.second].push_back((*boards)[k]);
+		work.push(make_pair(proc.first + (*jobs)[k].cost, proc.second));
+	}
+
+	for (int i = 1; i < numProcs; i++) {
+		printf("For Processor %d, Problem size: %lu\n", i, jobsOfProc[i].size());
+		masterSendJobList(&jobsOfProc[i], &boardsOfProc[i], i, deadline);
+	}
+	jobs->assign(jobsOfProc[0].begin(), jobsOfProc[0].end());
+	boards->assign(boardsOfProc[0].begin(), boardsOfProc[0].end());
+}
+
+// If waitingJobs is given, Jobs are sent with the window given by the results received so far
 void masterSendJobs(deque<Job>* jobs, deque<Board>* boards, int id, 
-	int jobSize, string jobDistribution) {
+	int jobSize, string jobDistribution, long long deadline, deque<CompletedJob>* waitingJobs) {
+	vector<Job> jobsToSend;
+	vector<Board> boardsToSend;
+	masterChooseJobs(jobs, boards, jobSize, jobDistribution, &jobsToSend, &boardsToSend);
+
+	if (waitingJobs != NULL) {
+		for (int j = 0; j < jobsToSend.size(); j++) {
+			masterGetJobWindow(waitingJobs, jobsToSend[j].id, &jobsToSend[j].alpha, &jobsToSend[j].beta);
+			(*waitingJobs)[jobsToSend[j].id].sentTo = id;
+		}
+	}
+
+	masterSendJobList(&jobsToSend, &boardsToSend, id, deadline);
+}
+
+// Take jobSize Jobs (and their Boards) out of the queue. Each Job is taken in constant time: 
+// RANDOM swaps the chosen Job to the front, the others take the front (See masterOrderJobs).
+void masterChooseJobs(deque<Job>* jobs, deque<Board>* boards, int jobSize, string jobDistribution,
+	vector<Job>* jobsToSend, vector<Board>* boardsToSend) {
 
 	// Determine whether jobs to be sent are chosen randomly or sequentially
 	bool randomizeJobDistribution = (jobDistribution.compare("RANDOM") == 0);
@@ -180,115 +769,81 @@ void masterSendJobs(deque<Job>* jobs, deque<Board>* boards, int id,
 	// Prevent Job size from being bigger than the number of Jobs
 	jobSize = min(jobSize, int(jobs->size()));
 	
-	int numJobs = jobs->size();
-	int jobsAllocated = 0;
-	vector<Job> jobsToSend;
-	vector<Board> boardsToSend;
 	for (int j = 0; j < jobSize; j++) {
-
 		if (randomizeJobDistribution) {
 			// Randomly choose the jobSize jobs
-			srand(time(NULL));
-			int randomId = rand() % (numJobs - jobsAllocated);
-			Job currentJob = (*jobs)[randomId];
-			jobs->erase(jobs->begin() + randomId);
-
-			boardsToSend.push_back(boards->at(randomId));
-			boards->erase(boards->begin() + randomId);
-			jobsAllocated++;
-
-			jobsToSend.push_back(currentJob);
-
-		} else {
-			// Choose the first Job that is available
-			Job currentJob = jobs->front();
-			jobs->erase(jobs->begin());
-
-			boardsToSend.push_back(boards->front());
-			boards->erase(boards->begin());
-
-			jobsToSend.push_back(currentJob);
+			int randomId = uniform_int_distribution<int>(0, jobs->size() - 1)(jobRandom);
+			swap((*jobs)[0], (*jobs)[randomId]);
+			swap((*boards)[0], (*boards)[randomId]);
 		}
-	}
 
-	// Send information
-	MPI_Send((void*)jobsToSend.data(), jobsToSend.size() * sizeof(Job), 
-		MPI_BYTE, id, 0, MPI_COMM_WORLD);
-	
-	// Send array data
-	int width = jobs->front().width;
-	int height = jobs->front().height;
-	for (int k = 0; k < boardsToSend.size(); k++) {
-		Board currentBoard = boardsToSend[k];
-		
-		for (int w = 0; w < width; w++) {
-			for (int h = 0; h < height; h++) {
-				// (+ 1) needed at the end because 0 was used to send just now
-				int uniqueTag = (w * width + h) + (k * width * height) + 1;
-				int num = currentBoard.getDisk(w, h);
-
-				MPI_Send(&num, 1, MPI_INT, id, uniqueTag, MPI_COMM_WORLD);
-			}
-		}
+		// Choose the first Job that is available
+		jobsToSend->push_back(jobs->front());
+		boardsToSend->push_back(boards->front());
+		jobs->pop_front();
+		boards->pop_front();
 	}
 }
 
-void slaveReceiveJobs(vector<Job>* jobs) {
-	// Probe for Jobs
-	MPI_Status status;
-	MPI_Probe(0, 0, MPI_COMM_WORLD, &status);
-
-	// Resize buffer based on how much data is being received
-	int incomingSize;
-	MPI_Get_count(&status, MPI_BYTE, &incomingSize);
-	jobs->resize(incomingSize / sizeof(Job));
-
-	// Receive configuration information of Jobs
-	MPI_Recv((void*)jobs->data(), incomingSize, MPI_BYTE, 0, 0, MPI_COMM_WORLD, 
-		MPI_STATUS_IGNORE);
-
-	// If no incoming Jobs, simply return
-	if (incomingSize == 0) {
+// LONGEST_FIRST: Jobs are sorted once from the most expensive (Costs are estimated when the Jobs
+// are split, See splitJobs), so that the most expensive Job left is always at the front
+void masterOrderJobs(deque<Job>* jobs, deque<Board>* boards, string jobDistribution) {
+	if (jobDistribution.compare("LONGEST_FIRST") != 0) {
 		return;
 	}
+	vector<pair<double, int> > costs;
+	for (int i = 0; i < jobs->size(); i++) {
+		costs.push_back(make_pair(-(*jobs)[i].cost, i));
+	}
+	sort(costs.begin(), costs.end());
 
-	// Receive array data of Jobs
-	int width = jobs->front().width;
-	int height = jobs->front().height;
-	for (int k = 0; k < jobs->size(); k++) {
+	deque<Job> sortedJobs;
+	deque<Board> sortedBoards;
+	for (int i = 0; i < costs.size(); i++) {
+		sortedJobs.push_back((*jobs)[costs[i].second]);
+		sortedBoards.push_back((*boards)[costs[i].second]);
+	}
+	jobs->swap(sortedJobs);
+	boards->swap(sortedBoards);
+}
 
-		Job* currentJob = &((*jobs)[k]);
-		Board* newBoard = new Board(width, height);
-		int data[width][height];
+// Seed of the RANDOM distribution (0 for a different seed every run)
+void setRandomSeed(unsigned int seed) {
+	jobRandom.seed((seed != 0) ? seed : random_device()());
+}
 
-		for (int w = 0; w < width; w++) {
-			for (int h = 0; h < height; h++) {
-				// (+ 1) needed at the end because 0 was used to send just now
-				int uniqueTag = (w * width + h) + (k * width * height) + 1;
-				
-				MPI_Recv(&data[w][h], 1, MPI_INT, 0, uniqueTag, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
-			}
-		}
+// Send the chosen Jobs and their Boards to a Slave in a single message (See wire.h)
+void masterSendJobList(vector<Job>* jobsToSend, vector<Board>* boardsToSend, int id, long long deadline) {
+	// Slaves count the time left from when they receive the Jobs
+	vector<uint8_t> message;
+	packJobs(&message, jobsToSend, boardsToSend, getTimeLimit(deadline));
+	sendMessage(&message, id, 0, jobComm);
+}
 
-		// Setup new board
-		for (int w = 0; w < width; w++) {
-			for (int h = 0; h < height; h++) {
-				newBoard->setDisk(data[w][h], w, h);
-			}
-		}
-		currentJob->board = newBoard;
+void slaveReceiveJobs(vector<Job>* jobs) {
+	vector<uint8_t> message;
+	receiveMessage(&message, 0, 0, jobComm);
+	abortOnBadMessage(unpackJobs(&message, &session, jobs));
+}
+
+// Release the Boards allocated by slaveReceiveJobs
+void slaveFreeJobs(vector<Job>* jobs) {
+	for (int k = 0; k < jobs->size(); k++) {
+		delete (*jobs)[k].board;
 	}
+	jobs->clear();
 }
 
 void slaveWaitForJob(string algorithm, int id) {
 	// For timing purposes
 	long long before, after;
 	vector<Job> jobsToWork;
+	slaveReceiveSession();
 
-	// Check if there are even Jobs first
+	// Master notifies the Slaves at the start of every search, until there are no more searches
 	int action;
-	MPI_Recv(&action, 1, MPI_INT, 0, 0, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
-	if (action == MASTER_SENDING_JOBS) {
+	MPI_Recv(&action, 1, MPI_INT, 0, 0, jobComm, MPI_STATUS_IGNORE);
+	while (action == MASTER_SENDING_JOBS) {
 
 		// Receive Jobs from master
 		before = wallClockTime();
@@ -298,7 +853,8 @@ void slaveWaitForJob(string algorithm, int id) {
 
 		// Work on problems
 		before = wallClockTime();
-	    vector<CompletedJob> completedJobs = executeAllJobs(algorithm, jobsToWork);
+	    vector<CompletedJob> completedJobs = executeAllJobs(algorithm, jobsToWork, false);
+	    slaveFreeJobs(&jobsToWork);
 	    after = wallClockTime();
 		compTime += after - before;
 		
@@ -307,13 +863,16 @@ void slaveWaitForJob(string algorithm, int id) {
 	    slaveSendCompletedJobs(&completedJobs);
 	    after = wallClockTime();
 		commTime += after - before;
+
+		MPI_Recv(&action, 1, MPI_INT, 0, 0, jobComm, MPI_STATUS_IGNORE);
 	}
 
 	printf(" --- SLAVE %2d FINISHED: Communication =%6.2f s; Computation =%6.2f s\n", 
 		id, commTime / 1000000000.0, compTime / 1000000000.0);
 }
 
-void masterWorkOnJobs(string algorithm, deque<Job>* jobs, deque<Board>* boards, deque<CompletedJob>* waitingJobs) {
+void masterWorkOnJobs(string algorithm, deque<Job>* jobs, deque<Board>* boards, deque<CompletedJob>* waitingJobs,
+	long long deadline) {
 	// If no jobs, return
 	if (int(jobs->size()) < 1) {
 		return;
@@ -323,10 +882,11 @@ void masterWorkOnJobs(string algorithm, deque<Job>* jobs, deque<Board>* boards,
 	for (int i = 0; i < jobs->size(); i++) {
 		Job job = (*jobs)[i];
 		job.board = &(*boards)[i];
+		job.timeLimit = getTimeLimit(deadline);
 		jobsToWork.push_back(job);
 	}
 	
-    vector<CompletedJob> completedJobs = executeAllJobs(algorithm, jobsToWork);
+    vector<CompletedJob> completedJobs = executeAllJobs(algorithm, jobsToWork, false);
     for (int i = 0; i < completedJobs.size(); i++) {
     	CompletedJob completedJob = completedJobs[i];
 		int id = completedJob.id;
@@ -340,8 +900,9 @@ void masterWorkOnJobs(string algorithm, deque<Job>* jobs, deque<Board>* boards,
 
 void slaveSendCompletedJobs(vector<CompletedJob>* jobs) {
 	// Send back to Processor 0 for results to be merged
-	MPI_Send((void*)jobs->data(), jobs->size() * sizeof(CompletedJob), 
-		MPI_BYTE, 0, 0, MPI_COMM_WORLD);
+	vector<uint8_t> message;
+	packCompletedJobs(&message, jobs);
+	sendMessage(&message, 0, 0, jobComm);
 	jobs->clear();
 }
 
@@ -349,16 +910,7 @@ void masterReceiveCompletedJobs(deque<CompletedJob>* waitingJobs, int numProcs)
 	vector<CompletedJob> incomingCompletedJobs;
 	for (int i = 1; i < numProcs; i++) {
 		// Probe for new incoming completed jobs
-		MPI_Status status;
-		MPI_Probe(MPI_ANY_SOURCE, 0, MPI_COMM_WORLD, &status);
-
-		// Resize your buffer based on how much data is being received
-		int incomingSize;
-		MPI_Get_count(&status, MPI_BYTE, &incomingSize);	
-		incomingCompletedJobs.resize(incomingSize / sizeof(CompletedJob));
-
-		MPI_Recv((void*)incomingCompletedJobs.data(), incomingSize, MPI_BYTE, 
-			status.MPI_SOURCE, 0, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+		masterReceiveCompletedJobList(&incomingCompletedJobs, MPI_ANY_SOURCE);
 
 		// Add to completed jobs
 		for (int j = 0; j < incomingCompletedJobs.size(); j++) {
@@ -374,73 +926,408 @@ void masterReceiveCompletedJobs(deque<CompletedJob>* waitingJobs, int numProcs)
 	}
 }
 
+// Results are passed on to the waiting Jobs straight away so that the next Jobs sent can use them
 void masterReceiveCompletedJobsFromSlave(deque<CompletedJob>* waitingJobs, int id) {
 	vector<CompletedJob> incomingCompletedJobs;
-	// Probe for new incoming completed jobs
-	MPI_Status status;
-	MPI_Probe(id, 0, MPI_COMM_WORLD, &status);
+	masterReceiveCompletedJobList(&incomingCompletedJobs, id);
+	masterCompleteJobs(waitingJobs, &incomingCompletedJobs);
+}
 
-	// Resize your incoming walker buffer based on how much data is being received
-	int incomingSize;
-	MPI_Get_count(&status, MPI_BYTE, &incomingSize);	
-	incomingCompletedJobs.resize(incomingSize / sizeof(CompletedJob));
-
-	MPI_Recv((void*)incomingCompletedJobs.data(), incomingSize, MPI_BYTE, 
-		status.MPI_SOURCE, 0, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
-	// Add to completed jobs
-	for (int j = 0; j < incomingCompletedJobs.size(); j++) {
-		CompletedJob completedJob = incomingCompletedJobs[j];
+// Pass the results of Jobs on to the waiting Jobs (Results of cancelled Jobs are ignored)
+void masterCompleteJobs(deque<CompletedJob>* waitingJobs, vector<CompletedJob>* completedJobs) {
+	for (int j = 0; j < completedJobs->size(); j++) {
+		CompletedJob completedJob = (*completedJobs)[j];
 		int id = completedJob.id;
 		int moveValue = completedJob.moveValue;
 		int boardsAssessed = completedJob.boardsAssessed;
+		(*waitingJobs)[id].boardsAssessed += boardsAssessed;
 
+		if ((*waitingJobs)[id].jobsLeft <= 0) {
+			continue;
+		}
 		(*waitingJobs)[id].moveValue = moveValue;
-		(*waitingJobs)[id].boardsAssessed += boardsAssessed;
+		(*waitingJobs)[id].jobsLeft--;
+		masterPropagateValue(waitingJobs, id);
+	}
+}
+
+// Count the results that each waiting Job needs: 1 for Jobs to be sent, else the number of children
+void masterInitialiseJobsLeft(deque<Job>* jobs, deque<CompletedJob>* waitingJobs) {
+	for (int i = 0; i < waitingJobs->size(); i++) {
+		(*waitingJobs)[i].jobsLeft = 0;
+	}
+	for (int i = 0; i < jobs->size(); i++) {
+		(*waitingJobs)[(*jobs)[i].id].jobsLeft = 1;
+	}
+	for (int i = 0; i < waitingJobs->size(); i++) {
+		int parentId = (*waitingJobs)[i].parentId;
+		if (parentId != -1) {
+			(*waitingJobs)[parentId].jobsLeft++;
+		}
+	}
+
+	// Boards that were over when splitting already have their values
+	for (int i = 0; i < waitingJobs->size(); i++) {
+		if ((*waitingJobs)[i].jobsLeft == 0) {
+			masterPropagateValue(waitingJobs, i);
+		}
+	}
+}
+
+// Pass the value of a waiting Job that is known on to its parent, and on to every ancestor whose 
+// value is then known
+void masterPropagateValue(deque<CompletedJob>* waitingJobs, int id) {
+	int parentId = (*waitingJobs)[id].parentId;
+	while (parentId != -1) {
+		CompletedJob* parentJob = &((*waitingJobs)[parentId]);
+		int moveValue = (*waitingJobs)[id].moveValue;
+
+		// Parent will choose to max (if it is BLACK) and min (if it is WHITE)
+		parentJob->moveValue = (parentJob->player == BLACK) ? 
+								max(parentJob->moveValue, moveValue) :
+								min(parentJob->moveValue, moveValue);
+		parentJob->jobsLeft--;
+		if (parentJob->jobsLeft > 0) {
+			return;
+		}
+
+		id = parentId;
+		parentId = parentJob->parentId;
+	}
+}
+
+// Narrow the window (BLACK's perspective) to search a Job with, given the results received so far
+void masterGetJobWindow(deque<CompletedJob>* waitingJobs, int id, int* alpha, int* beta) {
+	// At each ancestor, only moves better than the best move found so far matter
+	for (int i = (*waitingJobs)[id].parentId; i != -1; i = (*waitingJobs)[i].parentId) {
+		CompletedJob* ancestor = &((*waitingJobs)[i]);
+		if (ancestor->player == BLACK) {
+			*alpha = max(*alpha, ancestor->moveValue);
+		} else {
+			*beta = min(*beta, ancestor->moveValue);
+		}
+	}
+
+	// Original moves (The first waiting Jobs) as good as the best original move are also needed,
+	// as all the best moves are returned
+	int player = OPP(waitingJobs->front().player);
+	for (int i = 0; i < waitingJobs->size() && (*waitingJobs)[i].parentId == -1; i++) {
+		CompletedJob* originalJob = &((*waitingJobs)[i]);
+		if (originalJob->jobsLeft > 0) {
+			continue;
+		} else if (player == BLACK) {
+			*alpha = max(*alpha, originalJob->moveValue - 1);
+		} else {
+			*beta = min(*beta, originalJob->moveValue + 1);
+		}
 	}
-	incomingCompletedJobs.clear();
+}
+
+// True if the window of a waiting Job is empty (No value of the Job can change the result)
+bool masterIsJobCutOff(deque<CompletedJob>* waitingJobs, int id) {
+	int alpha = INT_MIN;
+	int beta = INT_MAX;
+	masterGetJobWindow(waitingJobs, id, &alpha, &beta);
+	return alpha >= beta;
+}
+
+// Cancel the waiting Jobs that can no longer change the result, together with the Jobs below them
+void masterCancelJobs(deque<Job>* jobs, deque<Board>* boards, deque<CompletedJob>* waitingJobs) {
+	for (int i = 0; i < waitingJobs->size(); i++) {
+		if ((*waitingJobs)[i].jobsLeft <= 0 || !masterIsJobCutOff(waitingJobs, i)) {
+			continue;
+		}
+
+		// Cancel the highest ancestor that is cut off, so that no value is passed on from below it
+		int id = i;
+		int parentId = (*waitingJobs)[id].parentId;
+		while (parentId != -1 && masterIsJobCutOff(waitingJobs, parentId)) {
+			id = parentId;
+			parentId = (*waitingJobs)[id].parentId;
+		}
+		masterCancelJob(jobs, boards, waitingJobs, id);
+	}
+}
+
+void masterCancelJob(deque<Job>* jobs, deque<Board>* boards, deque<CompletedJob>* waitingJobs, int id) {
+	// Find the waiting Jobs below the cancelled Job (Children always come after their parents)
+	vector<bool> cancelled(waitingJobs->size(), false);
+	cancelled[id] = true;
+	for (int i = id + 1; i < waitingJobs->size(); i++) {
+		int parentId = (*waitingJobs)[i].parentId;
+		cancelled[i] = (parentId != -1 && cancelled[parentId]);
+	}
+
+	// Jobs that have not been sent out are dropped
+	for (int i = jobs->size() - 1; i >= 0; i--) {
+		if (cancelled[(*jobs)[i].id]) {
+			jobs->erase(jobs->begin() + i);
+			boards->erase(boards->begin() + i);
+		}
+	}
+
+	// Jobs that are running are aborted. Every cancelled Job takes the value that its parent ignores,
+	// so that combining the results again (See masterRewindMinimaxStack) does not change anything.
+	for (int i = waitingJobs->size() - 1; i > id; i--) {
+		CompletedJob* job = &((*waitingJobs)[i]);
+		if (!cancelled[i]) {
+			continue;
+		} else if (job->jobsLeft > 0 && job->sentTo > 0) {
+			masterAbortJob(job->sentTo, i);
+		}
+		job->moveValue = (OPP(job->player) == BLACK) ? INT_MIN : INT_MAX;
+		job->jobsLeft = 0;
+	}
+
+	CompletedJob* job = &((*waitingJobs)[id]);
+	if (job->sentTo > 0) {
+		masterAbortJob(job->sentTo, id);
+	}
+	job->moveValue = (OPP(job->player) == BLACK) ? INT_MIN : INT_MAX;
+	job->jobsLeft = 0;
+	masterPropagateValue(waitingJobs, id);
+}
+
+// Tell a Slave to stop searching a Job of the current search round
+void masterAbortJob(int slave, int jobId) {
+	int abort[2] = {searchRound, jobId};
+	MPI_Send(abort, 2, MPI_INT, slave, ABORT_TAG, jobComm);
+}
+
+// Receive the aborts that Master has sent so far, and check if the Job is one of them
+bool slaveIsJobAborted(int jobId) {
+	return receiveAborts(jobComm, searchRound, &abortedJobs, jobId);
+}
+
+// Keep the aborts of a search round that have arrived from process 0 of comm
+bool receiveAborts(MPI_Comm comm, int round, vector<int>* aborted, int jobId) {
+	int flag;
+	MPI_Iprobe(0, ABORT_TAG, comm, &flag, MPI_STATUS_IGNORE);
+	while (flag) {
+		int abort[2];
+		MPI_Recv(abort, 2, MPI_INT, 0, ABORT_TAG, comm, MPI_STATUS_IGNORE);
+		if (abort[0] == round) {
+			aborted->push_back(abort[1]);
+		}
+		MPI_Iprobe(0, ABORT_TAG, comm, &flag, MPI_STATUS_IGNORE);
+	}
+	return find(aborted->begin(), aborted->end(), jobId) != aborted->end();
+}
+
+// Receive the Completed Jobs that a Slave is sending
+void masterReceiveCompletedJobList(vector<CompletedJob>* incomingCompletedJobs, int id) {
+	vector<uint8_t> message;
+	receiveMessage(&message, id, 0, jobComm);
+	abortOnBadMessage(unpackCompletedJobs(&message, incomingCompletedJobs));
+}
+
+// True if the Job is no longer needed. Master handles the requests of Slaves while it is
+// working on a Job itself, as the Job is checked every so often during the search.
+bool isJobAborted(int jobId) {
+	if (currentJobAborted != NULL) {
+		return *currentJobAborted;
+	} else if (workStealing != NULL) {
+		stealServe(workStealing);
+		return false;
+	} else if (masterJobPool != NULL) {
+		masterServeSlaves(masterJobPool);
+		return (*masterJobPool->waitingJobs)[jobId].jobsLeft <= 0;
+	}
+	return slaveIsJobAborted(jobId);
 }
 
 /******************************** JOB POOLING ********************************/
 
+// Number of Jobs to send to a Slave. With guided self-scheduling (jobPoolSendSize of 0), batches
+// start large and shrink with the Jobs left, and Slaves that complete Jobs faster than the 
+// average Slave get more of them.
+int masterGetBatchSize(JobPool* pool, int slave) {
+	if (pool->jobPoolSendSize > 0) {
+		return pool->jobPoolSendSize;
+	}
+	int jobsLeft = pool->jobs->size();
+	double batchSize = (double) jobsLeft / (GUIDED_FACTOR * pool->numProcs);
+
+	// Throughput (Jobs per ns) of this Slave against the average of the Slaves measured so far
+	double totalRate = 0;
+	int measured = 0;
+	for (int i = 1; i < pool->numProcs; i++) {
+		if (pool->busyTime[i] > 0) {
+			totalRate += (double) pool->jobsDone[i] / pool->busyTime[i];
+			measured++;
+		}
+	}
+	if (pool->busyTime[slave] > 0 && totalRate > 0) {
+		batchSize *= ((double) pool->jobsDone[slave] / pool->busyTime[slave]) / (totalRate / measured);
+	}
+	return max(1, min(jobsLeft, (int) ceil(batchSize)));
+}
+
+// The results of the oldest running batch of the Slave have arrived. Slaves request their next 
+// batch before they work on the current one, so a batch is worked on from when it was sent or
+// when the previous results arrived, whichever is later.
+void masterRecordBatch(JobPool* pool, int slave) {
+	if (pool->batchesSent[slave].empty()) {
+		return;
+	}
+	pair<int, long long> batch = pool->batchesSent[slave].front();
+	pool->batchesSent[slave].pop_front();
+
+	long long now = wallClockTime();
+	pool->jobsDone[slave] += batch.first;
+	pool->busyTime[slave] += now - max(batch.second, pool->lastResultTime[slave]);
+	pool->lastResultTime[slave] = now;
+}
+
+// Handle a request sent by a Slave
+void masterHandleRequest(JobPool* pool, int slave, int request) {
+	long long before = wallClockTime();
+
+	// Jobs that have not been sent out will not finish in time
+	if (pool->deadline > 0 && wallClockTime() >= pool->deadline) {
+		pool->jobs->clear();
+		pool->boards->clear();
+	}
+
+	if (request == SLAVE_WANTS_JOBS) {
+		masterGenerateJobs(pool);
+	}
+
+	if (request == SLAVE_WANTS_JOBS && pool->jobs->size() > 0) {
+
+		// If there are Jobs, send those Jobs the Slaves are requesting for them
+		int response = MASTER_SENDING_JOBS;
+		int batchSize = masterGetBatchSize(pool, slave);
+		MPI_Send(&response, 1, MPI_INT, slave, 0, jobComm);
+		masterSendJobs(pool->jobs, pool->boards, slave, batchSize, pool->jobDistribution,
+			pool->deadline, pool->waitingJobs);
+		pool->batchesRunning++;
+		if (pool->jobPoolSendSize <= 0) {
+			pool->batchesSent[slave].push_back(make_pair(batchSize, wallClockTime()));
+		}
+
+	} else if (request == SLAVE_WANTS_JOBS && pool->jobs->size() <= 0) {
+
+		// If there are no more Jobs, inform the Slaves so that they will stop requesting
+		int response = MASTER_NO_JOBS;
+		MPI_Send(&response, 1, MPI_INT, slave, 0, jobComm);
+		pool->finishedSlaves++;
+
+	} else if (request == SLAVE_SENDING_JOBS) {
+
+		// Collect results from Slaves, and cancel the Jobs that are no longer needed
+		masterReceiveCompletedJobsFromSlave(pool->waitingJobs, slave);
+		masterCancelJobs(pool->jobs, pool->boards, pool->waitingJobs);
+		pool->batchesRunning--;
+		if (pool->jobPoolSendSize <= 0) {
+			masterRecordBatch(pool, slave);
+		}
+	}
+	pool->commTime += wallClockTime() - before;
+}
+
+// Handle the requests that Slaves have sent so far, without waiting for more
+void masterServeSlaves(JobPool* pool) {
+	int flag;
+	MPI_Status status;
+	MPI_Iprobe(MPI_ANY_SOURCE, 0, jobComm, &flag, &status);
+	while (flag) {
+		int request;
+		MPI_Recv(&request, 1, MPI_INT, status.MPI_SOURCE, 0, jobComm, MPI_STATUS_IGNORE);
+		masterHandleRequest(pool, status.MPI_SOURCE, request);
+		MPI_Iprobe(MPI_ANY_SOURCE, 0, jobComm, &flag, &status);
+	}
+}
+
+// Master works on a Job of the pool itself, handling the requests of Slaves during the search
+void masterWorkOnJobPool(string algorithm, JobPool* pool) {
+	masterGenerateJobs(pool);
+	vector<Job> jobsToWork;
+	vector<Board> boardsToWork;
+	masterChooseJobs(pool->jobs, pool->boards, 1, pool->jobDistribution, &jobsToWork, &boardsToWork);
+	for (int j = 0; j < jobsToWork.size(); j++) {
+		masterGetJobWindow(pool->waitingJobs, jobsToWork[j].id, &jobsToWork[j].alpha, &jobsToWork[j].beta);
+		jobsToWork[j].board = &boardsToWork[j];
+		jobsToWork[j].timeLimit = getTimeLimit(pool->deadline);
+	}
+
+	masterJobPool = pool;
+	vector<CompletedJob> completedJobs = executeAllJobs(algorithm, jobsToWork, true);
+	masterJobPool = NULL;
+
+	masterCompleteJobs(pool->waitingJobs, &completedJobs);
+	masterCancelJobs(pool->jobs, pool->boards, pool->waitingJobs);
+}
+
 // Receive Job requests from slaves and send some Jobs to slaves
 void slaveRequestJob(string algorithm, int id) {
+	slaveReceiveSession();
+
+	// Master notifies the Slaves at the start of every search, until there are no more searches
+	int action;
+	MPI_Recv(&action, 1, MPI_INT, 0, 0, jobComm, MPI_STATUS_IGNORE);
+	while (action == MASTER_SENDING_JOBS) {
+		searchRound++;
+		abortedJobs.clear();
+		slaveRequestJobsForSearch(algorithm);
+
+		// Aborts that arrived after the last Job of the round are not needed
+		slaveIsJobAborted(-1);
+		MPI_Recv(&action, 1, MPI_INT, 0, 0, jobComm, MPI_STATUS_IGNORE);
+	}
+	slaveIsJobAborted(-1);
+
+	printf(" --- SLAVE %2d FINISHED: Communication =%6.2f s; Computation =%6.2f s\n", 
+		id, commTime / 1000000000.0, compTime / 1000000000.0);
+}
+
+// Keep requesting for Jobs until Master has no more Jobs for the current search.
+// The next Jobs are requested before working on the current ones, and results are sent without
+// waiting, so that Master's answers arrive while the Slave is computing.
+void slaveRequestJobsForSearch(string algorithm) {
 	// For timing purposes
 	long long before, after;
 
-	while (true) {
-		int request = SLAVE_WANTS_JOBS;
-		MPI_Send(&request, 1, MPI_INT, 0, 0, MPI_COMM_WORLD);
+	// Messages that may still be in flight: Next request, announcement of results, results
+	MPI_Request sends[3] = {MPI_REQUEST_NULL, MPI_REQUEST_NULL, MPI_REQUEST_NULL};
+	int request = SLAVE_WANTS_JOBS;
+	int announcement = SLAVE_SENDING_JOBS;
+	vector<uint8_t> results;
 
-		MPI_Status status;
+	MPI_Isend(&request, 1, MPI_INT, 0, 0, jobComm, &sends[0]);
+	while (true) {
+		// Wait for the Jobs that were requested
+		before = wallClockTime();
 		int response;
-		MPI_Recv(&response, 1, MPI_INT, 0, 0, MPI_COMM_WORLD, &status);
+		MPI_Recv(&response, 1, MPI_INT, 0, 0, jobComm, MPI_STATUS_IGNORE);
+		after = wallClockTime();
+		commTime += after - before;
 
 		if (response == MASTER_SENDING_JOBS) {
-			// Receive Jobs from master
+			// Receive Jobs from master, and request for the next Jobs straight away
 			before = wallClockTime();
 			vector<Job> jobsToWork;
 			slaveReceiveJobs(&jobsToWork);
+			MPI_Wait(&sends[0], MPI_STATUS_IGNORE);
+			MPI_Isend(&request, 1, MPI_INT, 0, 0, jobComm, &sends[0]);
 			after = wallClockTime();
 			commTime += after - before;
 
 		    // Work on problems
 			before = wallClockTime();
-		    vector<CompletedJob> completedJobs = executeAllJobs(algorithm, jobsToWork);
+		    vector<CompletedJob> completedJobs = executeAllJobs(algorithm, jobsToWork, true);
+		    slaveFreeJobs(&jobsToWork);
 		    after = wallClockTime();
 			compTime += after - before;
 
-			// Request to send Completed Jobs back to Master
+			// Return results to master (The previous results must have been sent to reuse the buffer)
 			before = wallClockTime();
-	  		request = SLAVE_SENDING_JOBS;
-			MPI_Send(&request, 1, MPI_INT, 0, 0, MPI_COMM_WORLD);
+			MPI_Waitall(2, &sends[1], MPI_STATUSES_IGNORE);
+			packCompletedJobs(&results, &completedJobs);
+			MPI_Isend(&announcement, 1, MPI_INT, 0, 0, jobComm, &sends[1]);
+			MPI_Isend((void*)results.data(), results.size(), MPI_BYTE, 0, 0, jobComm, &sends[2]);
 			after = wallClockTime();
 			commTime += after - before;
-			
-			// Return results to master
-			before = wallClockTime();
-		    slaveSendCompletedJobs(&completedJobs);
-		    after = wallClockTime();
-			commTime += after - before;
 
 		} else if (response == MASTER_NO_JOBS) {
 			break;
@@ -452,10 +1339,491 @@ void slaveRequestJob(string algorithm, int id) {
 		}
 	}
 
+	before = wallClockTime();
+	MPI_Waitall(3, sends, MPI_STATUSES_IGNORE);
+	after = wallClockTime();
+	commTime += after - before;
+}
+
+/******************************** WORK STEALING ******************************/
+
+// Master deals the Jobs of every search out to all processes, which then work on their own Jobs
+void slaveStealJobs(string algorithm, int id) {
+	slaveReceiveSession();
+	stealSeed = id;
+
+	// Master notifies the Slaves at the start of every search, until there are no more searches
+	int action;
+	MPI_Recv(&action, 1, MPI_INT, 0, 0, jobComm, MPI_STATUS_IGNORE);
+	while (action == MASTER_SENDING_JOBS) {
+		deque<Job> jobs;
+		deque<Board> boards;
+		WorkStealing ws = {algorithm, id, 0, &jobs, &boards, 0, -1, false, NULL, 0};
+		MPI_Comm_size(jobComm, &ws.numProcs);
+
+		// Receive the Jobs dealt to this Slave
+		long long before = wallClockTime();
+		vector<Job> dealtJobs;
+		slaveReceiveJobs(&dealtJobs);
+		stealAddJobs(&ws, &dealtJobs);
+		commTime += wallClockTime() - before;
+
+		stealJobs(&ws);
+		MPI_Recv(&action, 1, MPI_INT, 0, 0, jobComm, MPI_STATUS_IGNORE);
+	}
+
 	printf(" --- SLAVE %2d FINISHED: Communication =%6.2f s; Computation =%6.2f s\n", 
 		id, commTime / 1000000000.0, compTime / 1000000000.0);
 }
 
+// Work on the Jobs of this process, and steal Jobs from a random process when there are none left,
+// until Master has all the results of the search. Requests for Jobs are answered during searches.
+void stealJobs(WorkStealing* ws) {
+	long long before, after;
+
+	while (true) {
+		stealServe(ws);
+		if (ws->done) {
+			break;
+		}
+
+		if (ws->jobs->size() > 0) {
+			// Newest Jobs are worked on first, the oldest are given away
+			vector<Job> jobsToWork(1, ws->jobs->back());
+			Board board = ws->boards->back();
+			ws->jobs->pop_back();
+			ws->boards->pop_back();
+			jobsToWork[0].board = &board;
+			jobsToWork[0].timeLimit = getTimeLimit(ws->deadline);
+
+			before = wallClockTime();
+			workStealing = ws;
+			vector<CompletedJob> completedJobs = executeAllJobs(ws->algorithm, jobsToWork, true);
+			workStealing = NULL;
+			after = wallClockTime();
+			compTime += after - before;
+
+			stealCompleteJobs(ws, &completedJobs);
+
+		} else if (ws->victim < 0 && ws->numProcs > 1) {
+			// Ask a random process for some of its Jobs
+			ws->victim = rand_r(&stealSeed) % (ws->numProcs - 1);
+			ws->victim += (ws->victim >= ws->id) ? 1 : 0;
+			int request = SLAVE_WANTS_JOBS;
+			MPI_Send(&request, 1, MPI_INT, ws->victim, STEAL_REQUEST_TAG, jobComm);
+		}
+	}
+
+	// Requests may still be on their way, so keep answering them until every process has its replies
+	before = wallClockTime();
+	while (ws->victim >= 0) {
+		stealServe(ws);
+	}
+	MPI_Request barrier;
+	MPI_Ibarrier(jobComm, &barrier);
+	int flag = 0;
+	while (!flag) {
+		stealServe(ws);
+		MPI_Test(&barrier, &flag, MPI_STATUS_IGNORE);
+	}
+	commTime += wallClockTime() - before;
+}
+
+// Handle the messages that have arrived: Requests for Jobs, replies to this process' request, 
+// results (Master) and the end of the search (Slaves)
+void stealServe(WorkStealing* ws) {
+	int flag;
+	MPI_Status status;
+
+	MPI_Iprobe(MPI_ANY_SOURCE, STEAL_REQUEST_TAG, jobComm, &flag, &status);
+	while (flag) {
+		int request;
+		MPI_Recv(&request, 1, MPI_INT, status.MPI_SOURCE, STEAL_REQUEST_TAG, jobComm, 
+			MPI_STATUS_IGNORE);
+		stealReply(ws, status.MPI_SOURCE);
+		MPI_Iprobe(MPI_ANY_SOURCE, STEAL_REQUEST_TAG, jobComm, &flag, &status);
+	}
+
+	if (ws->victim >= 0) {
+		MPI_Iprobe(ws->victim, STEAL_REPLY_TAG, jobComm, &flag, MPI_STATUS_IGNORE);
+		if (flag) {
+			vector<uint8_t> message;
+			vector<Job> stolenJobs;
+			receiveMessage(&message, ws->victim, STEAL_REPLY_TAG, jobComm);
+			abortOnBadMessage(unpackJobs(&message, &session, &stolenJobs));
+			stealAddJobs(ws, &stolenJobs);
+			ws->victim = -1;
+		}
+	}
+
+	if (ws->done) {
+		return;
+	} else if (ws->id != 0) {
+		// Master tells the Slaves once it has all the results
+		MPI_Iprobe(0, 0, jobComm, &flag, MPI_STATUS_IGNORE);
+		if (flag) {
+			int action;
+			MPI_Recv(&action, 1, MPI_INT, 0, 0, jobComm, MPI_STATUS_IGNORE);
+			ws->done = true;
+		}
+		return;
+	}
+
+	MPI_Iprobe(MPI_ANY_SOURCE, 0, jobComm, &flag, MPI_STATUS_IGNORE);
+	while (flag) {
+		vector<CompletedJob> completedJobs;
+		masterReceiveCompletedJobList(&completedJobs, MPI_ANY_SOURCE);
+		stealCompleteJobs(ws, &completedJobs);
+		MPI_Iprobe(MPI_ANY_SOURCE, 0, jobComm, &flag, MPI_STATUS_IGNORE);
+	}
+	if (ws->resultsLeft == 0) {
+		masterNotifySlaves(ws->numProcs, MASTER_NO_JOBS);
+		ws->done = true;
+	}
+}
+
+// Add Jobs received from another process (Boards allocated by unpackJobs are released)
+void stealAddJobs(WorkStealing* ws, vector<Job>* jobs) {
+	for (int k = 0; k < jobs->size(); k++) {
+		Job job = (*jobs)[k];
+		if (ws->deadline == 0 && job.timeLimit > 0) {
+			ws->deadline = wallClockTime() + job.timeLimit;
+		}
+		ws->boards->push_back(*job.board);
+		delete job.board;
+		job.board = NULL;
+		ws->jobs->push_back(job);
+	}
+	jobs->clear();
+}
+
+// Give half of the Jobs of this process (The oldest ones) to a process that asked for them
+void stealReply(WorkStealing* ws, int thief) {
+	vector<Job> jobsToSend;
+	vector<Board> boardsToSend;
+	int numJobs = ws->jobs->size() / 2;
+	for (int k = 0; k < numJobs; k++) {
+		jobsToSend.push_back(ws->jobs->front());
+		boardsToSend.push_back(ws->boards->front());
+		ws->jobs->pop_front();
+		ws->boards->pop_front();
+	}
+
+	vector<uint8_t> message;
+	packJobs(&message, &jobsToSend, &boardsToSend, getTimeLimit(ws->deadline));
+	sendMessage(&message, thief, STEAL_REPLY_TAG, jobComm);
+}
+
+// Results go to Master, which combines them
+void stealCompleteJobs(WorkStealing* ws, vector<CompletedJob>* completedJobs) {
+	if (ws->id != 0) {
+		slaveSendCompletedJobs(completedJobs);
+		return;
+	}
+	masterCompleteJobs(ws->waitingJobs, completedJobs);
+	ws->resultsLeft -= completedJobs->size();
+}
+
+/**************************** ONE-SIDED JOB QUEUE ***************************/
+
+// Windows are allocated by MPI (rather than created on existing memory), so that processes on the
+// same node as Master can access them directly
+void allocateJobQueue(JobQueue* queue, int jobsSize, int resultsSize) {
+	MPI_Win_allocate(jobsSize, 1, MPI_INFO_NULL, jobComm, &queue->jobs, &queue->jobsWin);
+	MPI_Win_allocate((jobsSize > 0) ? sizeof(int) : 0, sizeof(int), MPI_INFO_NULL, jobComm, 
+		&queue->nextJob, &queue->nextJobWin);
+	MPI_Win_allocate(resultsSize * sizeof(int), sizeof(int), MPI_INFO_NULL, jobComm, 
+		&queue->results, &queue->resultsWin);
+}
+
+// Master exposes the Jobs of the search, the index of the next Job and the results in windows,
+// which are created together by all processes
+void masterCreateJobQueue(JobQueue* queue, vector<uint8_t>* packedJobs, int numJobs, int jobSize, 
+	long long deadline) {
+	long long parameters[3] = {numJobs, jobSize, getTimeLimit(deadline)};
+	MPI_Bcast(parameters, 3, MPI_LONG_LONG, 0, jobComm);
+	queue->numJobs = numJobs;
+	queue->jobSize = jobSize;
+	queue->deadline = deadline;
+	allocateJobQueue(queue, max(1, numJobs * jobSize), 3 * numJobs);
+
+	MPI_Win_lock(MPI_LOCK_EXCLUSIVE, 0, 0, queue->jobsWin);
+	copy(packedJobs->begin(), packedJobs->end(), queue->jobs);
+	MPI_Win_unlock(0, queue->jobsWin);
+	MPI_Win_lock(MPI_LOCK_EXCLUSIVE, 0, 0, queue->nextJobWin);
+	*queue->nextJob = 0;
+	MPI_Win_unlock(0, queue->nextJobWin);
+
+	// Jobs cannot be claimed before they are in the window
+	MPI_Barrier(jobComm);
+}
+
+void slaveCreateJobQueue(JobQueue* queue) {
+	long long parameters[3];
+	MPI_Bcast(parameters, 3, MPI_LONG_LONG, 0, jobComm);
+	queue->numJobs = parameters[0];
+	queue->jobSize = parameters[1];
+	queue->deadline = (parameters[2] > 0) ? wallClockTime() + parameters[2] : 0;
+	allocateJobQueue(queue, 0, 0);
+	MPI_Barrier(jobComm);
+}
+
+// Claim the next Job with an atomic increment, read it and write its result in Master's windows,
+// until every Job has been claimed. Master does not take part in the hand-off of Jobs.
+void claimJobs(string algorithm, JobQueue* queue) {
+	long long before, after;
+	int one = 1;
+	vector<uint8_t> message(queue->jobSize);
+
+	MPI_Win_lock_all(0, queue->jobsWin);
+	MPI_Win_lock_all(0, queue->nextJobWin);
+	MPI_Win_lock_all(0, queue->resultsWin);
+	while (true) {
+		before = wallClockTime();
+		int k;
+		MPI_Fetch_and_op(&one, &k, MPI_INT, 0, 0, MPI_SUM, queue->nextJobWin);
+		MPI_Win_flush(0, queue->nextJobWin);
+		if (k >= queue->numJobs) {
+			commTime += wallClockTime() - before;
+			break;
+		}
+
+		vector<Job> jobsToWork;
+		MPI_Get(message.data(), queue->jobSize, MPI_BYTE, 0, (MPI_Aint)k * queue->jobSize, queue->jobSize, 
+			MPI_BYTE, queue->jobsWin);
+		MPI_Win_flush(0, queue->jobsWin);
+		abortOnBadMessage(unpackJobs(&message, &session, &jobsToWork));
+		jobsToWork[0].timeLimit = getTimeLimit(queue->deadline);
+		after = wallClockTime();
+		commTime += after - before;
+
+		before = wallClockTime();
+		vector<CompletedJob> completedJobs = executeAllJobs(algorithm, jobsToWork, false);
+		slaveFreeJobs(&jobsToWork);
+		after = wallClockTime();
+		compTime += after - before;
+
+		before = wallClockTime();
+		int result[3] = {completedJobs[0].id, completedJobs[0].moveValue, completedJobs[0].boardsAssessed};
+		MPI_Put(result, 3, MPI_INT, 0, 3 * k, 3, MPI_INT, queue->resultsWin);
+		MPI_Win_flush(0, queue->resultsWin);
+		commTime += wallClockTime() - before;
+	}
+	MPI_Win_unlock_all(queue->resultsWin);
+	MPI_Win_unlock_all(queue->nextJobWin);
+	MPI_Win_unlock_all(queue->jobsWin);
+}
+
+// Every process waits until there are no more Jobs, so that Master can read the results (If 
+// completedJobs is given) before the windows are freed
+void freeJobQueue(JobQueue* queue, vector<CompletedJob>* completedJobs) {
+	long long before = wallClockTime();
+	MPI_Barrier(jobComm);
+	if (completedJobs != NULL) {
+		MPI_Win_lock(MPI_LOCK_EXCLUSIVE, 0, 0, queue->resultsWin);
+		for (int k = 0; k < queue->numJobs; k++) {
+			int* result = &queue->results[3 * k];
+			CompletedJob completedJob = {result[0], -1, EMPTY, result[1], result[2], 0, 0};
+			completedJobs->push_back(completedJob);
+		}
+		MPI_Win_unlock(0, queue->resultsWin);
+	}
+	MPI_Win_free(&queue->jobsWin);
+	MPI_Win_free(&queue->nextJobWin);
+	MPI_Win_free(&queue->resultsWin);
+	commTime += wallClockTime() - before;
+}
+
+void slaveClaimJobs(string algorithm, int id) {
+	slaveReceiveSession();
+
+	// Master notifies the Slaves at the start of every search, until there are no more searches
+	int action;
+	MPI_Recv(&action, 1, MPI_INT, 0, 0, jobComm, MPI_STATUS_IGNORE);
+	while (action == MASTER_SENDING_JOBS) {
+		JobQueue queue;
+		slaveCreateJobQueue(&queue);
+		claimJobs(algorithm, &queue);
+		freeJobQueue(&queue, NULL);
+		MPI_Recv(&action, 1, MPI_INT, 0, 0, jobComm, MPI_STATUS_IGNORE);
+	}
+
+	printf(" --- SLAVE %2d FINISHED: Communication =%6.2f s; Computation =%6.2f s\n", 
+		id, commTime / 1000000000.0, compTime / 1000000000.0);
+}
+
+/*************************** HIERARCHICAL JOB POOLING *************************/
+
+// Processes 1, 2, 3... are split into groups of groupSize processes. The first process of a group
+// is its Sub-master: A Slave of Master (in topComm) and the Master of the rest of its group (in 
+// groupComm), so that Master only talks to the Sub-masters.
+void joinGroups(int id, int groupSize) {
+	groupSize = max(1, groupSize);
+	bool subMaster = (id == 0 || (id - 1) % groupSize == 0);
+	MPI_Comm_split(MPI_COMM_WORLD, subMaster ? 0 : MPI_UNDEFINED, id, &topComm);
+	MPI_Comm_split(MPI_COMM_WORLD, (id == 0) ? MPI_UNDEFINED : (id - 1) / groupSize, id, &groupComm);
+}
+
+// Master serves the Sub-masters only, returns the number of processes it talks to
+int masterJoinGroups() {
+	int numProcs;
+	joinGroups(0, 1);
+	jobComm = topComm;
+	MPI_Comm_size(jobComm, &numProcs);
+	return numProcs;
+}
+
+void slaveJoinGroup(string algorithm, int id, int groupSize, string jobDistribution, int numJobsPerProc,
+	int jobPoolSendSize) {
+	joinGroups(id, groupSize);
+	jobComm = groupComm;
+
+	int groupId;
+	MPI_Comm_rank(groupComm, &groupId);
+	if (groupId == 0) {
+		subMasterRequestJob(algorithm, id, jobDistribution, numJobsPerProc, jobPoolSendSize);
+	} else {
+		slaveRequestJob(algorithm, id);
+	}
+}
+
+// Sub-masters request coarse Jobs from Master, and split each of them into a Job pool for the group
+void subMasterRequestJob(string algorithm, int id, string jobDistribution, int numJobsPerProc, 
+	int jobPoolSendSize) {
+	int groupProcs;
+	MPI_Comm_size(groupComm, &groupProcs);
+
+	// Pass the parameters of the search on to the group
+	vector<uint8_t> message;
+	receiveMessage(&message, 0, 0, topComm);
+	abortOnBadMessage(unpackSession(&message, &session));
+	masterSendSession(groupProcs, session.width, session.height, session.maxBoards, 
+		session.cornerValue, session.edgeValue, session.tableSize);
+
+	// Master notifies the Sub-masters at the start of every search, until there are no more searches.
+	// Aborts from Master are kept apart from the aborts that the Sub-master sends to its group.
+	int topRound = 0;
+	vector<int> topAbortedJobs;
+	int action;
+	MPI_Recv(&action, 1, MPI_INT, 0, 0, topComm, MPI_STATUS_IGNORE);
+	while (action == MASTER_SENDING_JOBS) {
+		topRound++;
+		topAbortedJobs.clear();
+
+		int request = SLAVE_WANTS_JOBS;
+		int announcement = SLAVE_SENDING_JOBS;
+		while (true) {
+			long long before = wallClockTime();
+			int response;
+			MPI_Send(&request, 1, MPI_INT, 0, 0, topComm);
+			MPI_Recv(&response, 1, MPI_INT, 0, 0, topComm, MPI_STATUS_IGNORE);
+			if (response != MASTER_SENDING_JOBS) {
+				commTime += wallClockTime() - before;
+				break;
+			}
+			vector<Job> coarseJobs;
+			receiveMessage(&message, 0, 0, topComm);
+			abortOnBadMessage(unpackJobs(&message, &session, &coarseJobs));
+			commTime += wallClockTime() - before;
+
+			vector<CompletedJob> completedJobs;
+			for (int k = 0; k < coarseJobs.size(); k++) {
+				completedJobs.push_back(subMasterWorkOnJob(algorithm, &coarseJobs[k], groupProcs, 
+					jobDistribution, numJobsPerProc, jobPoolSendSize, topRound, &topAbortedJobs));
+			}
+			slaveFreeJobs(&coarseJobs);
+
+			before = wallClockTime();
+			MPI_Send(&announcement, 1, MPI_INT, 0, 0, topComm);
+			packCompletedJobs(&message, &completedJobs);
+			sendMessage(&message, 0, 0, topComm);
+			commTime += wallClockTime() - before;
+		}
+
+		// Aborts that arrived after the last Job of the round are not needed
+		receiveAborts(topComm, topRound, &topAbortedJobs, -1);
+		MPI_Recv(&action, 1, MPI_INT, 0, 0, topComm, MPI_STATUS_IGNORE);
+	}
+	receiveAborts(topComm, topRound, &topAbortedJobs, -1);
+	masterNotifySlaves(groupProcs, MASTER_NO_JOBS);
+
+	printf(" --- SUB-MASTER %2d FINISHED: Communication =%6.2f s; Computation =%6.2f s\n", 
+		id, commTime / 1000000000.0, compTime / 1000000000.0);
+}
+
+// Search a coarse Job with the group like Master searches the original moves with the Job pool.
+// Each coarse Job is a search round of the group, which ends once every Slave of the group is told 
+// there are no more Jobs. Jobs of the group are cancelled if Master aborts the coarse Job.
+CompletedJob subMasterWorkOnJob(string algorithm, Job* coarseJob, int groupProcs, string jobDistribution,
+	int numJobsPerProc, int jobPoolSendSize, int topRound, vector<int>* topAbortedJobs) {
+	masterNotifySlaves(groupProcs, MASTER_SENDING_JOBS);
+
+	// The coarse Job is the only original move of the group (Its window is passed on when splitting)
+	deque<Job> jobs;
+	deque<Board> boards;
+	deque<CompletedJob> waitingJobs;
+	Job rootJob = *coarseJob;
+	rootJob.id = 0;
+	rootJob.parentId = -1;
+	jobs.push_back(rootJob);
+	boards.push_back(*coarseJob->board);
+	CompletedJob rootWaitingJob = {
+		0, -1, rootJob.player, ((rootJob.player == BLACK) ? INT_MIN : INT_MAX), 0, 0, 0
+	};
+	waitingJobs.push_back(rootWaitingJob);
+
+	long long before = wallClockTime();
+	splitJobs(&jobs, &boards, &waitingJobs, groupProcs, getInitialJobsPerProc(numJobsPerProc));
+	masterOrderJobs(&jobs, &boards, jobDistribution);
+	masterInitialiseJobsLeft(&jobs, &waitingJobs);
+	compTime += wallClockTime() - before;
+
+	long long deadline = (coarseJob->timeLimit > 0) ? wallClockTime() + coarseJob->timeLimit : 0;
+	JobPool pool = {&jobs, &boards, &waitingJobs, jobDistribution, jobPoolSendSize, deadline, 0, 0, 0, 
+		groupProcs, numJobsPerProc, vector<deque<pair<int, long long> > >(groupProcs), 
+		vector<long long>(groupProcs, 0), vector<int>(groupProcs, 0), vector<long long>(groupProcs, 0)};
+	bool aborted = false;
+	while (jobs.size() > 0 || pool.finishedSlaves < groupProcs - 1 || pool.batchesRunning > 0) {
+
+		// Master no longer needs the coarse Job
+		if (!aborted && receiveAborts(topComm, topRound, topAbortedJobs, coarseJob->id)) {
+			masterCancelJob(&jobs, &boards, &waitingJobs, 0);
+			aborted = true;
+			continue;
+		}
+
+		// Sub-master works on a Job itself while no Slave of the group is waiting for it
+		int waiting;
+		MPI_Iprobe(MPI_ANY_SOURCE, 0, groupComm, &waiting, MPI_STATUS_IGNORE);
+		if (!waiting && jobs.size() > 0) {
+			before = wallClockTime();
+			long long commTimeBefore = pool.commTime;
+			masterWorkOnJobPool(algorithm, &pool);
+			compTime += (wallClockTime() - before) - (pool.commTime - commTimeBefore);
+			continue;
+		}
+
+		MPI_Status status;
+		before = wallClockTime();
+		int request;
+		MPI_Recv(&request, 1, MPI_INT, MPI_ANY_SOURCE, 0, groupComm, &status);
+		commTime += wallClockTime() - before;
+		masterHandleRequest(&pool, status.MPI_SOURCE, request);
+	}
+	commTime += pool.commTime;
+
+	// Combine the results of the group
+	before = wallClockTime();
+	masterRewindMinimaxStack(&waitingJobs);
+	compTime += wallClockTime() - before;
+
+	CompletedJob completedJob = {
+		coarseJob->id, coarseJob->parentId, coarseJob->player, waitingJobs[0].moveValue,
+		waitingJobs[0].boardsAssessed, 0, 0
+	};
+	return completedJob;
+}
+
 /*************************** COMBINATION OF RESULTS **************************/
 
 // Combine evaluations by Slave processes to get minimax value for original moves
@@ -479,4 +1847,35 @@ void masterRewindMinimaxStack(deque<CompletedJob>* jobs) {
 		jobs->pop_back();
 		job = jobs->back();
 	}
+}
+
+// Best moves from the minimax values of the original moves (See masterRewindMinimaxStack). The
+// boards assessed by the Jobs are added to boardsAssessed.
+vector<point> masterGetBestMoves(deque<CompletedJob>* jobs, vector<point>& validMoves, int player, 
+	int* boardsAssessed) {
+	vector<point> minimaxMoves;
+	int bestValue = (player == BLACK) ? INT_MIN : INT_MAX;
+	for (int i = 0; i < jobs->size(); i++) {
+		point validMove = validMoves[i];
+		int newValue = (*jobs)[i].moveValue;
+		*boardsAssessed += (*jobs)[i].boardsAssessed;
+
+		if (player == BLACK && newValue > bestValue) {
+			// Clear previous moves
+			bestValue = newValue;
+			minimaxMoves.clear();
+			minimaxMoves.push_back(validMove);
+
+		} else if (player == WHITE && newValue < bestValue) { 
+			// Clear previous moves
+			bestValue = newValue;
+			minimaxMoves.clear();
+			minimaxMoves.push_back(validMove);
+
+		} else if (newValue == bestValue) {
+			// Add on to a previous move with same value
+			minimaxMoves.push_back(validMove);
+		}
+	}
+	return minimaxMoves;
 }
\ No newline at end of file
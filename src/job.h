@@ -3,7 +3,13 @@
 #define JOB_H
 
 #include <mpi.h>
+#include <atomic>
+#include <chrono>
+#include <thread>
 #include <deque>
+#include <algorithm>
+#include <queue>
+#include <random>
 #include <vector>
 #include <math.h>
 #include <time.h>
@@ -19,6 +25,19 @@
 #define MASTER_SENDING_JOBS 2
 #define MASTER_NO_JOBS 3
 
+// Jobs per processor that splitting creates at most (Master keeps a waiting Job for each Job)
+#define MAX_JOBS_PER_PROC 100
+
+// Guided self-scheduling sends the Jobs left divided by this many times the number of processors
+#define GUIDED_FACTOR 2
+
+// Tag of the messages that Master sends to abort a Job that is running (Other messages use tag 0)
+#define ABORT_TAG 1
+
+// Tags of the messages between processes that steal Jobs from each other (See stealJobs)
+#define STEAL_REQUEST_TAG 2
+#define STEAL_REPLY_TAG 3
+
 using namespace std;
 
 typedef struct {
@@ -32,12 +51,19 @@ typedef struct {
 	int maxBoards;
 	int cornerValue;
 	int edgeValue;
+	int tableSize;
 
 	// State of Job
 	int player;
 	int depthLeft;
 	int boardsAssessed;
+	int alpha;				// Window to search the Job with (BLACK's perspective)
+	int beta;
+	long long timeLimit;	// Time left (ns) when the Job was sent, 0 if there is no Timeout
 	Board* board;
+
+	// Estimated boards that the Job assesses (Master only, See estimateJobCost)
+	double cost;
 } Job;
 
 typedef struct {
@@ -50,34 +76,220 @@ typedef struct {
 	int moveValue;
 	int boardsAssessed;
 
+	// Number of results that a waiting Job still needs before its value is known (Master only)
+	int jobsLeft;
+
+	// Slave that the Job was sent to, 0 if it has not been sent (Master only)
+	int sentTo;
+
 } CompletedJob;
 
+// Job pool of Master (See Solver::getJobPoolMoves)
+typedef struct {
+	deque<Job>* jobs;
+	deque<Board>* boards;
+	deque<CompletedJob>* waitingJobs;
+	string jobDistribution;
+	int jobPoolSendSize;
+	long long deadline;
+
+	// Progress of the search
+	int finishedSlaves;		// Slaves that have been told that there are no Jobs
+	int batchesRunning;		// Batches of Jobs sent to Slaves whose results have not been received
+	long long commTime;
+
+	int numProcs;
+	int numJobsPerProc;		// Jobs per processor that are generated (See masterGenerateJobs)
+
+	// Guided self-scheduling (jobPoolSendSize of 0, See masterGetBatchSize)
+	vector<deque<pair<int, long long> > > batchesSent;	// Size and time sent of running batches
+	vector<long long> lastResultTime;
+	vector<int> jobsDone;
+	vector<long long> busyTime;
+} JobPool;
+
+// Jobs of a process that steals Jobs from other processes when it runs out (See stealJobs)
+typedef struct {
+	string algorithm;
+	int id;
+	int numProcs;
+	deque<Job>* jobs;
+	deque<Board>* boards;
+	long long deadline;		// Time at which the search has to stop in this process, 0 if none
+	int victim;				// Process that has been asked for Jobs and has not replied, -1 if none
+	bool done;				// Master has all the results of the search
+
+	// Master only
+	deque<CompletedJob>* waitingJobs;
+	int resultsLeft;		// Jobs whose results have not been received
+} WorkStealing;
+
+// Jobs in windows on Master that every process claims from with one-sided communication
+// (See claimJobs). Slaves only have empty windows.
+typedef struct {
+	MPI_Win jobsWin;		// Jobs packed one by one (See wire.h), each of jobSize bytes
+	MPI_Win nextJobWin;		// Index of the next Job to claim
+	MPI_Win resultsWin;		// id, moveValue and boardsAssessed of each Job
+	uint8_t* jobs;			// Memory of the windows (Master only)
+	int* nextJob;
+	int* results;
+	int numJobs;
+	int jobSize;
+	long long deadline;		// Time at which the search has to stop in this process, 0 if none
+} JobQueue;
+
+// Stores to the distributed transposition table that are sent together (See storeDistributedTable)
+// This is also the number of reads that can be in progress (See prefetchDistributedTable)
+#define DISTRIBUTED_TABLE_BATCH_SIZE 64
+
+// Transposition table split across all processes: The hash of a position gives the process that
+// keeps it (See getDistributedSlot). Only the thread that uses MPI reads and writes it.
+typedef struct {
+	MPI_Win win;
+	TTSlot* slots;			// Slots kept by this process
+	long long numSlots;		// Slots per process
+	int numProcs;
+	int minDepth;			// Only positions with at least this depth left are distributed
+	vector<TTSlot> pendingStores;	// Sent but not completed, so the memory has to be kept
+
+	// Reads in progress (MPI_REQUEST_NULL if the read is free)
+	vector<MPI_Request> probeRequests;
+	vector<TTSlot> probeResults;
+	vector<uint64_t> probeKeys;
+	vector<int> freeProbes;
+	vector<int> completedProbes;
+} DistributedTable;
+
+// Jobs of a process that are shared by its worker threads (See executeJobsInThreads)
+typedef struct {
+	string algorithm;
+	vector<Job>* jobs;
+	vector<CompletedJob>* completedJobs;
+	atomic<bool>* aborted;	// Set by the thread that uses MPI
+	long long deadline;
+	bool abortable;
+	atomic<int> nextJob;
+	atomic<int> jobsDone;
+} ThreadedJobs;
+
+// Processes that the Job functions talk to (MPI_COMM_WORLD, or a group of processes)
+extern MPI_Comm jobComm;
+
 // Timing purposes
 long long wallClockTime();
 
+// Transposition table shared by every search of the processes of a node
+TranspositionTable* getTranspositionTable(int tableSize);
+void createTranspositionTable(int tableSize);
+void freeTranspositionTable();
+void createDistributedTable(int tableSize, int minDepth);
+void freeDistributedTable();
+void getDistributedSlot(uint64_t key, int* owner, MPI_Aint* slot);
+bool usesDistributedTable(int depth);
+void prefetchDistributedTable(uint64_t key, int depth);
+void receiveDistributedTable(TranspositionTable* table, int depth);
+void storeDistributedTable(uint64_t key, int depth, int bound, int value, int bestMove);
+void flushDistributedTable();
+
 // Job-specific functions
-CompletedJob executeMinimaxJob(Job* job);
-CompletedJob executeAlphaBetaJob(Job* job);
-vector<CompletedJob> executeAllJobs(string algorithm, vector<Job>* job);
+CompletedJob executeMinimaxJob(Job* job, long long deadline, bool abortable);
+CompletedJob executeAlphaBetaJob(Job* job, long long deadline, bool abortable);
+CompletedJob executePVSJob(Job* job, long long deadline, bool abortable);
+vector<CompletedJob> executeAllJobs(string algorithm, vector<Job> job, bool abortable);
+CompletedJob executeJob(string algorithm, Job* job, long long deadline, bool abortable);
+
+// Threads
+void setNumThreads(int threads);
+int getNumThreads();
+vector<CompletedJob> executeJobsInThreads(string algorithm, vector<Job>* jobs, long long deadline, 
+	bool abortable);
+void executeJobsInThread(ThreadedJobs* threadedJobs);
 
 // Communications
+long long getTimeLimit(long long deadline);
+void sendMessage(vector<uint8_t>* message, int id, int tag, MPI_Comm comm);
+int receiveMessage(vector<uint8_t>* message, int id, int tag, MPI_Comm comm);
+void abortOnBadMessage(bool ok);
+void masterSendSession(int numProcs, int width, int height, int maxBoards, int cornerValue, int edgeValue,
+	int tableSize);
+void slaveReceiveSession();
 void masterNotifySlaves(int numProcs, int action);
 void masterInitialiseJobs(deque<Job>* jobs, deque<Board>* boards, deque<CompletedJob>* waitingJobs, 
-	vector<point> validMoves, Board board, int player, int depth, int maxBoards, int cornerValue, int edgeValue);
+	vector<point> validMoves, Board board, int player, int depth, int maxBoards, int cornerValue, int edgeValue,
+	int tableSize);
+double estimateJobCost(Job* job, Board* board);
 void splitJobs(deque<Job>* jobs, deque<Board>* boards, deque<CompletedJob>* waitingJobs,
 	int numProcs, int jobsPerProc);
+int splitJob(deque<Job>* jobs, deque<Board>* boards, deque<CompletedJob>* waitingJobs, int index);
+int getMostExpensiveJob(deque<Job>* jobs);
+void setJobFrontier(int jobsPerProc);
+int getInitialJobsPerProc(int numJobsPerProc);
+void masterGenerateJobs(JobPool* pool);
 
 void slaveWaitForJob(string algorithm, int id);
-void masterSendBatchJobs(deque<Job>* jobs, deque<Board>* boards, int numProcs, string jobDistribution);
-void masterSendJobs(deque<Job>* jobs, deque<Board>* boards, int id, int numJobs, string jobDistribution);
+void masterSendBatchJobs(deque<Job>* jobs, deque<Board>* boards, int numProcs, string jobDistribution,
+	long long deadline);
+void masterSendLongestFirstJobs(deque<Job>* jobs, deque<Board>* boards, int numProcs, long long deadline);
+void masterSendJobs(deque<Job>* jobs, deque<Board>* boards, int id, int numJobs, string jobDistribution,
+	long long deadline, deque<CompletedJob>* waitingJobs);
+void masterChooseJobs(deque<Job>* jobs, deque<Board>* boards, int jobSize, string jobDistribution,
+	vector<Job>* jobsToSend, vector<Board>* boardsToSend);
+void masterOrderJobs(deque<Job>* jobs, deque<Board>* boards, string jobDistribution);
+void setRandomSeed(unsigned int seed);
+void masterSendJobList(vector<Job>* jobs, vector<Board>* boards, int id, long long deadline);
 void slaveReceiveJobs(vector<Job>* jobs);
-void masterWorkOnJobs(string algorithm, deque<Job>* jobs, deque<Board>* boards, deque<CompletedJob>* waitingJobs);
+void slaveFreeJobs(vector<Job>* jobs);
+void masterWorkOnJobs(string algorithm, deque<Job>* jobs, deque<Board>* boards, deque<CompletedJob>* waitingJobs,
+	long long deadline);
 void slaveSendCompletedJobs(vector<CompletedJob>* jobs);
 void masterReceiveCompletedJobs(deque<CompletedJob>* jobs, int numProcs);
 void masterReceiveCompletedJobsFromSlave(deque<CompletedJob>* jobs, int id);
+void masterCompleteJobs(deque<CompletedJob>* waitingJobs, vector<CompletedJob>* completedJobs);
+void masterInitialiseJobsLeft(deque<Job>* jobs, deque<CompletedJob>* waitingJobs);
+void masterPropagateValue(deque<CompletedJob>* waitingJobs, int id);
+void masterGetJobWindow(deque<CompletedJob>* waitingJobs, int id, int* alpha, int* beta);
+bool masterIsJobCutOff(deque<CompletedJob>* waitingJobs, int id);
+void masterCancelJobs(deque<Job>* jobs, deque<Board>* boards, deque<CompletedJob>* waitingJobs);
+void masterCancelJob(deque<Job>* jobs, deque<Board>* boards, deque<CompletedJob>* waitingJobs, int id);
+void masterAbortJob(int slave, int jobId);
+bool slaveIsJobAborted(int jobId);
+bool receiveAborts(MPI_Comm comm, int round, vector<int>* aborted, int jobId);
+bool isJobAborted(int jobId);
+void masterReceiveCompletedJobList(vector<CompletedJob>* jobs, int id);
 
+int masterGetBatchSize(JobPool* pool, int slave);
+void masterRecordBatch(JobPool* pool, int slave);
+void masterHandleRequest(JobPool* pool, int slave, int request);
+void masterServeSlaves(JobPool* pool);
+void masterWorkOnJobPool(string algorithm, JobPool* pool);
 void slaveRequestJob(string algorithm, int id);
+void slaveRequestJobsForSearch(string algorithm);
+
+void slaveStealJobs(string algorithm, int id);
+void stealJobs(WorkStealing* ws);
+void stealServe(WorkStealing* ws);
+void stealAddJobs(WorkStealing* ws, vector<Job>* jobs);
+void stealReply(WorkStealing* ws, int thief);
+void stealCompleteJobs(WorkStealing* ws, vector<CompletedJob>* completedJobs);
+
+void masterCreateJobQueue(JobQueue* queue, vector<uint8_t>* packedJobs, int numJobs, int jobSize, 
+	long long deadline);
+void slaveCreateJobQueue(JobQueue* queue);
+void claimJobs(string algorithm, JobQueue* queue);
+void freeJobQueue(JobQueue* queue, vector<CompletedJob>* completedJobs);
+void slaveClaimJobs(string algorithm, int id);
+
+void joinGroups(int id, int groupSize);
+int masterJoinGroups();
+void slaveJoinGroup(string algorithm, int id, int groupSize, string jobDistribution, int numJobsPerProc,
+	int jobPoolSendSize);
+void subMasterRequestJob(string algorithm, int id, string jobDistribution, int numJobsPerProc, 
+	int jobPoolSendSize);
+CompletedJob subMasterWorkOnJob(string algorithm, Job* coarseJob, int groupProcs, string jobDistribution,
+	int numJobsPerProc, int jobPoolSendSize, int topRound, vector<int>* topAbortedJobs);
 
 void masterRewindMinimaxStack(deque<CompletedJob>* jobs);
+vector<point> masterGetBestMoves(deque<CompletedJob>* jobs, vector<point>& validMoves, int player, 
+	int* boardsAssessed);
 
 #endif
\ No newline at end of file
@@ -0,0 +1,233 @@
+#include "jobtree.h"
+#include "solver.h"
+#include <algorithm>
+#include <deque>
+
+using namespace std;
+
+JobTree::JobTree(Solver* s, Board board, int player, int depth) : solver(s), numLeaves(1) {
+	addNode(-1, point(-1, -1), player, depth, board);
+}
+
+int JobTree::addNode(int parent, point move, int player, int depthLeft, Board& board) {
+	JobNode node = {
+		parent, move, player, depthLeft, board, vector<int>(), 0, -1,
+		((player == BLACK) ? INT_MIN : INT_MAX), NODE_WAITING, 0
+	};
+	nodes.push_back(node);
+	return nodes.size() - 1;
+}
+
+/********************************* SPLITTING *********************************/
+
+void JobTree::split(int minLeaves) {
+	deque<int> leaves;
+	leaves.push_back(0);
+
+	while (numLeaves < minLeaves && leaves.size() > 0) {
+		int id = leaves.front();
+		leaves.pop_front();
+
+		// Boards that are over or at the last depth are searched as they are
+		Board board = nodes[id].board;
+		int player = nodes[id].player;
+		int depthLeft = nodes[id].depthLeft;
+		if (board.isGameOver() || depthLeft <= 0) {
+			continue;
+		}
+
+		// Children are ordered so that the eldest child is most likely the best move
+		vector<point> validMoves;
+		solver->getOrderedMoves(board, player, depthLeft, validMoves);
+		if (validMoves.size() == 0) {
+			// Skip to next player if no moves
+			int child = addNode(id, point(-1, -1), OPP(player), depthLeft, board);
+			nodes[id].children.push_back(child);
+			leaves.push_back(child);
+			continue;
+		}
+
+		for (int i = 0; i < validMoves.size(); i++) {
+			Board newBoard = board;
+			newBoard.makeMove(player, validMoves[i].x, validMoves[i].y);
+			int child = addNode(id, validMoves[i], OPP(player), depthLeft - 1, newBoard);
+			nodes[id].children.push_back(child);
+			leaves.push_back(child);
+		}
+		numLeaves += validMoves.size() - 1;
+	}
+}
+
+/********************************* SCHEDULING ********************************/
+
+// Returns the next leaf that can be searched, or -1 if all of them have to wait
+int JobTree::getNextJob() {
+	return findJob(0);
+}
+
+int JobTree::findJob(int id) {
+	JobNode* node = &nodes[id];
+	if (node->state == NODE_DONE) {
+		return -1;
+	} else if (node->children.size() == 0) {
+		return (node->state == NODE_WAITING) ? id : -1;
+	}
+
+	// Values of the ancestors may have cut off this node since it was last checked
+	if (id != 0 && isCutOff(id)) {
+		finishNode(id);
+		return -1;
+	}
+
+	// Young brothers wait for the eldest brother to be done
+	int eldest = node->children[0];
+	if (nodes[eldest].state != NODE_DONE) {
+		return findJob(eldest);
+	}
+
+	for (int i = 1; i < node->children.size(); i++) {
+		int job = findJob(node->children[i]);
+		if (job >= 0) {
+			return job;
+		} else if (node->state == NODE_DONE) {
+			// A child that was cut off has finished this node
+			return -1;
+		}
+	}
+	return -1;
+}
+
+// Window (BLACK's perspective) to search a node with, given the values found so far
+void JobTree::getWindow(int id, int* alpha, int* beta) {
+	int parentId = nodes[id].parent;
+	if (parentId == -1) {
+		*alpha = INT_MIN;
+		*beta = INT_MAX;
+		return;
+	}
+
+	getWindow(parentId, alpha, beta);
+	JobNode* parent = &nodes[parentId];
+	if (parent->numDone == 0) {
+		return;
+	}
+
+	// Only moves better than the best brother matter. At the root, moves that are as good as
+	// the best move are also needed (All the best moves are returned).
+	int margin = (parentId == 0) ? 1 : 0;
+	if (parent->player == BLACK) {
+		*alpha = max(*alpha, parent->value - margin);
+	} else {
+		*beta = min(*beta, parent->value + margin);
+	}
+}
+
+void JobTree::setRunning(int id, int slave) {
+	nodes[id].state = NODE_RUNNING;
+	nodes[id].slave = slave;
+}
+
+// Results of a leaf searched by a Slave
+void JobTree::completeJob(int id, int value) {
+	// Results of Jobs that have been cut off are not needed
+	if (nodes[id].state == NODE_DONE || isAbandoned(id)) {
+		return;
+	}
+	nodes[id].value = value;
+	finishNode(id);
+}
+
+bool JobTree::isDone() {
+	return nodes[0].state == NODE_DONE;
+}
+
+// Leaves that are running although an ancestor is done without them. They are marked as done so 
+// that they are only returned once.
+vector<int> JobTree::abandonJobs() {
+	vector<int> abandoned;
+	for (int i = 0; i < nodes.size(); i++) {
+		if (nodes[i].state == NODE_RUNNING && isAbandoned(i)) {
+			nodes[i].state = NODE_DONE;
+			abandoned.push_back(i);
+		}
+	}
+	return abandoned;
+}
+
+// True if the value of the node is already outside of its window (The rest of it is not needed)
+bool JobTree::isCutOff(int id) {
+	JobNode* node = &nodes[id];
+	if (node->numDone == 0) {
+		return false;
+	}
+
+	int alpha, beta;
+	getWindow(id, &alpha, &beta);
+	return (node->player == BLACK) ? node->value >= beta : node->value <= alpha;
+}
+
+// True if an ancestor is done without needing this node
+bool JobTree::isAbandoned(int id) {
+	for (int i = nodes[id].parent; i != -1; i = nodes[i].parent) {
+		if (nodes[i].state == NODE_DONE) {
+			return true;
+		}
+	}
+	return false;
+}
+
+// Marks the node as done and passes its value on to its parent
+void JobTree::finishNode(int id) {
+	JobNode* node = &nodes[id];
+	node->state = NODE_DONE;
+
+	// Keep the values of the top of the tree for the next search (eg. Iterative deepening)
+	if (node->bestChild >= 0) {
+		int alpha, beta;
+		getWindow(id, &alpha, &beta);
+		point move = nodes[node->bestChild].move;
+		int bestMove = (move.x < 0) ? -1 : move.x * node->board.getHeight() + move.y;
+		solver->storeTranspositionTable(node->board.getHash(node->player), alpha, beta,
+			node->depthLeft, node->value, bestMove);
+	}
+
+	int parentId = node->parent;
+	if (parentId == -1) {
+		return;
+	}
+
+	JobNode* parent = &nodes[parentId];
+	parent->numDone++;
+	if ((parent->player == BLACK && node->value > parent->value) ||
+		(parent->player == WHITE && node->value < parent->value) || parent->bestChild < 0) {
+		parent->value = node->value;
+		parent->bestChild = id;
+	}
+
+	if (parent->numDone == parent->children.size() || (parentId != 0 && isCutOff(parentId))) {
+		finishNode(parentId);
+	}
+}
+
+/********************************** RESULTS **********************************/
+
+// Moves of the root with the minimax value, in the order of Board::getValidMoves
+vector<point> JobTree::getBestMoves() {
+	vector<point> bestMoves;
+	vector<int> cells;
+	JobNode* root = &nodes[0];
+	int height = root->board.getHeight();
+
+	for (int i = 0; i < root->children.size(); i++) {
+		JobNode* child = &nodes[root->children[i]];
+		if (child->value == root->value) {
+			cells.push_back(child->move.x * height + child->move.y);
+		}
+	}
+
+	sort(cells.begin(), cells.end());
+	for (int i = 0; i < cells.size(); i++) {
+		bestMoves.push_back(point(cells[i] / height, cells[i] % height));
+	}
+	return bestMoves;
+}
@@ -0,0 +1,75 @@
+#ifndef JOBTREE_H
+#define JOBTREE_H
+
+#include <vector>
+#include <climits>
+#include "board.h"
+#include "point.h"
+#include "disk.h"
+
+// States of a node in the JobTree
+#define NODE_WAITING 0	// Not searched yet
+#define NODE_RUNNING 1	// Sent to a Slave (Leaves only)
+#define NODE_DONE 2		// Value is known, or the node no longer matters (Cut off)
+
+using namespace std;
+
+class Solver;
+
+typedef struct {
+	int parent;				// -1 for the root
+	point move;				// Move made by the parent to reach this node
+	int player;				// Player to move
+	int depthLeft;
+	Board board;
+	vector<int> children;	// In the order they are searched (Eldest child first)
+	int numDone;			// Number of children that are done
+	int bestChild;
+	int value;				// Best value of the children so far (BLACK's perspective)
+	int state;
+	int slave;				// Slave that the node was sent to (Leaves only)
+} JobNode;
+
+/*
+ * Top of the game tree that Master splits into Jobs for the Young Brothers Wait Concept:
+ * The eldest child of a node has to be searched before its younger brothers can be searched,
+ * and the younger brothers are searched with the window given by the values found so far.
+ *
+ * Leaves of the tree are the Jobs that are searched by Slaves.
+ */
+class JobTree {
+	public:
+		JobTree(Solver* s, Board board, int player, int depth);
+
+		// Splits leaves (Breadth first) until there are at least minLeaves leaves
+		void split(int minLeaves);
+
+		// Scheduling
+		int getNextJob();
+		void getWindow(int id, int* alpha, int* beta);
+		void setRunning(int id, int slave);
+		void completeJob(int id, int value);
+		bool isDone();
+		vector<int> abandonJobs();
+
+		// Results
+		vector<point> getBestMoves();
+
+		// Helpers
+		JobNode* getNode(int id) { return &nodes[id]; };
+		int getNumNodes() { return nodes.size(); };
+		int getNumLeaves() { return numLeaves; };
+
+	protected:
+		Solver* solver;		// Orders the moves of the nodes and keeps their values
+		vector<JobNode> nodes;
+		int numLeaves;
+
+		int addNode(int parent, point move, int player, int depthLeft, Board& board);
+		int findJob(int id);
+		bool isCutOff(int id);
+		bool isAbandoned(int id);
+		void finishNode(int id);
+};
+
+#endif
@@ -28,13 +28,55 @@ using namespace std;
  * 5) JOBPOOL_MINIMAX:
  *    Master maintains a pool of Jobs that have to be evaluated and Slave processors request 
  *    for Jobs to work on. Boards are then sent to Slave processors in small mini-batches to
- *    be evaluated using the minimax algorithm.
+ *    be evaluated using the minimax algorithm. Master also works on Jobs of the pool while
+ *    no Slave processor is waiting for it.
  *
  * 6) JOBPOOL_ALPHABETA:
  *    Master maintains a pool of Jobs that have to be evaluated and Slave processors request 
  *    for Jobs to work on. Boards are then sent to Slave processors in small mini-batches to
  *    be evaluated using the minimax alpha-beta pruning algorithm.
  *
+ * 7) SERIAL_PVS:
+ *    Serial version of the principal variation search algorithm (Alpha-beta pruning where all
+ *    but the first move of each board are searched with a null window).
+ *
+ * 8) BATCH_PVS:
+ *    Same as BATCH_ALPHABETA, but boards are evaluated using principal variation search.
+ *
+ * 9) JOBPOOL_PVS:
+ *    Same as JOBPOOL_ALPHABETA, but boards are evaluated using principal variation search.
+ *
+ * 10) SERIAL_MTDF:
+ *    Serial version of the MTD(f) algorithm, which finds the minimax value with a series of
+ *    null window alpha-beta searches. Requires a transposition table (TranspositionTableSize).
+ *
+ * 11) YBWC_ALPHABETA:
+ *    Parallel alpha-beta pruning using the Young Brothers Wait Concept. Master splits the boards
+ *    like the other parallel algorithms, but the first move of a board has to be evaluated
+ *    before its other moves are sent to Slave processors (1 board per request), together with
+ *    the alpha-beta window found so far.
+ *
+ * 12) STEALING_MINIMAX / STEALING_ALPHABETA / STEALING_PVS:
+ *    Master deals the boards out to all processors once instead of keeping a pool. Processors
+ *    that run out of boards steal half of the boards of a random processor, and send their
+ *    results to Master.
+ *
+ * 13) HIERARCHICAL_MINIMAX / HIERARCHICAL_ALPHABETA / HIERARCHICAL_PVS:
+ *    Job pooling on 2 levels for large numbers of processors. Processors are split into groups
+ *    of GROUP_SIZE processors. Master sends coarse Jobs to the first processor of each group 
+ *    (Sub-master), which splits them into a Job pool for the rest of its group and sends the 
+ *    combined result back to Master.
+ *
+ * 14) RMA_MINIMAX / RMA_ALPHABETA / RMA_PVS:
+ *    Job pooling without requests to Master. Master exposes the boards in MPI windows, and each 
+ *    processor (Master included) claims the next board with an atomic increment, reads it and
+ *    writes the result back with one-sided communication.
+ *
+ * 15) SMP_ALPHABETA / SMP_PVS:
+ *    Lazy SMP on Master only. NUM_THREADS threads search the same tree and share the 
+ *    transposition table (TranspositionTableSize must not be 0). Helper threads start from 
+ *    different moves, and the main thread finds their values in the table.
+ *
  */
 string ALGORITHM = "JOBPOOL_ALPHABETA";
 
@@ -49,9 +91,20 @@ string ALGORITHM = "JOBPOOL_ALPHABETA";
  * 2) RANDOM:
  *    Randomly chooses K boards to send out of the total N boards.
  *
+ * 3) LONGEST_FIRST:
+ *    Sends the K boards that are estimated to take the longest to search. For BATCH algorithms,
+ *    each board (longest first) goes to the processor with the least work so far.
+ *
  */
 string JOB_DISTRIBUTION = "RANDOM";
 
+/*
+ * (Only applicable for the RANDOM job distribution)
+ * This is the seed of the random choice of boards, so that a run can be repeated (0 to use a 
+ * different seed every run).
+ */
+#define RANDOM_SEED 0
+
 /*
  * This is the number of Jobs that each processor should roughly work on. If there less Jobs
  * that this, Master will split the current Jobs into more granular Jobs.
@@ -60,24 +113,95 @@ string JOB_DISTRIBUTION = "RANDOM";
  */
 #define NUM_JOBS_PER_PROC 1
 
+/*
+ * (Only applicable for JOBPOOL and HIERARCHICAL algorithms)
+ * If this is not 0, Master does not split all the Jobs before the search starts. Jobs are split
+ * as processors ask for them, and Master keeps at most this many Jobs per processor that have not
+ * been sent, until NUM_JOBS_PER_PROC Jobs per processor have been generated. Only these Jobs keep
+ * their boards, so fewer boards are kept while the search runs.
+ */
+#define JOB_FRONTIER_PER_PROC 0
+
 /*
  * (Only applicable for JOBPOOL_MINIMAX / JOBPOOL_ALPHABETA algorithms)
  * This is the number of boards to send per Job request by Slave processors.
+ *
+ * If this is 0, the number is chosen for each request (Guided self-scheduling): The boards left
+ * divided by GUIDED_FACTOR times the number of processors, more for Slave processors that have
+ * been faster than the others. Requests are few while there are many boards left, and the last
+ * boards are sent one by one.
  */
 #define JOBPOOL_SEND_SIZE 1
+
+/*
+ * (Only applicable for HIERARCHICAL algorithms)
+ * This is the number of processors in each group, Sub-master included. Groups should not span
+ * more than 1 node (eg. the number of processors per node).
+ */
+#define GROUP_SIZE 4
+
+/*
+ * This is the number of threads that each processor uses to work on the Jobs it is sent at
+ * once (1 to work on them one by one). With more threads, 1 processor per node can be run
+ * instead of 1 processor per core, and JOBPOOL_SEND_SIZE should be at least this number.
+ * For SMP algorithms, this is the number of threads of Master that search the same tree.
+ */
+#define NUM_THREADS 1
+
+/*
+ * (Only applicable if TranspositionTableSize is not 0)
+ * Positions with at least this depth left are also kept in a transposition table split across all
+ * processors, so that a processor does not search again what another processor has searched.
+ * Each processor keeps TranspositionTableSize MB of it. Positions are read before they are 
+ * searched without waiting for the processor that keeps them, so this should be large enough 
+ * that the reads arrive in time (0 to disable). Worker threads cannot use MPI, so the table is 
+ * not used if NUM_THREADS is more than 1.
+ */
+#define DISTRIBUTED_TABLE_DEPTH 0
 /****************************************************************************************/
 
 
 int main(int argc, char** argv) {
 
-	MPI_Init(NULL, NULL);
+	// Only the main thread of a processor uses MPI (See executeJobsInThreads)
+	int threadSupport;
+	MPI_Init_thread(NULL, NULL, MPI_THREAD_FUNNELED, &threadSupport);
   	int numProcs, id;
   	MPI_Comm_size(MPI_COMM_WORLD, &numProcs);
   	MPI_Comm_rank(MPI_COMM_WORLD, &id);
 
+	// Threads need the MPI library to support at least MPI_THREAD_FUNNELED
+	int numThreads = NUM_THREADS;
+	if (numThreads > 1 && threadSupport < MPI_THREAD_FUNNELED) {
+		if (id == 0) {
+			cout << "Warning: NUM_THREADS is ignored as MPI does not support threads" << endl;
+		}
+		numThreads = 1;
+	}
+  	setNumThreads(numThreads);
+  	setRandomSeed(RANDOM_SEED);
+  	setJobFrontier(JOB_FRONTIER_PER_PROC);
+
+	// Processes of a node share 1 transposition table (Only Master reads the configurations)
+	Config* config = (id == 0) ? new Config(argv[1], argv[2]) : NULL;
+	int tableSize = (config != NULL) ? config->getTableSize() : 0;
+	MPI_Bcast(&tableSize, 1, MPI_INT, 0, MPI_COMM_WORLD);
+	createTranspositionTable(tableSize);
+
+	// Only the thread that uses MPI reads and writes the distributed table, and Jobs are searched
+	// by worker threads if there are more than 1
+	int distributedDepth = DISTRIBUTED_TABLE_DEPTH;
+	if (distributedDepth > 0 && getNumThreads() > 1) {
+		if (id == 0) {
+			cout << "Warning: DISTRIBUTED_TABLE_DEPTH is ignored as NUM_THREADS is more than 1" << endl;
+		}
+		distributedDepth = 0;
+	}
+	createDistributedTable(tableSize, distributedDepth);
+
   	if (id == 0) {
-		// Retrieve configurations
-		Config cf = Config(argv[1], argv[2]);
+		// Configurations were read before the transposition table was created
+		Config& cf = *config;
 
 		// Setup the board
 		int maxDepth = cf.getMaxDepth();
@@ -87,32 +211,13 @@ int main(int argc, char** argv) {
 
 		// Initialize solver
 		Solver solver = Solver(cf);
+		solver.setTranspositionTable(getTranspositionTable(cf.getTableSize()));
 
 		board.printBoard(currentPlayer);
 
-		// Master acts differently depending on algorithm
-		vector<point> validMoves;
-		/************************* SERIAL *************************/
-		if (ALGORITHM.compare("SERIAL_MINIMAX") == 0) {
-			validMoves = solver.getMinimaxMoves(board, currentPlayer, maxDepth);
-
-		} else if (ALGORITHM.compare("SERIAL_ALPHABETA") == 0) {
-			validMoves = solver.getAlphaBetaMoves(board, currentPlayer, maxDepth);
-
-
-		/************** SENDING PROBLEMS AS A BATCH ***************/
-		} else if (ALGORITHM.compare("BATCH_MINIMAX") == 0 || 
-				   ALGORITHM.compare("BATCH_ALPHABETA") == 0) {
-			validMoves = solver.getBatchMoves(board, currentPlayer, maxDepth, numProcs, 
-				ALGORITHM, JOB_DISTRIBUTION, NUM_JOBS_PER_PROC);
-
-
-		/********************** JOB POOLING ***********************/ 
-		} else if (ALGORITHM.compare("JOBPOOL_MINIMAX") == 0 ||
-				   ALGORITHM.compare("JOBPOOL_ALPHABETA") == 0) {
-			validMoves = solver.getJobPoolMoves(board, currentPlayer, maxDepth, numProcs, 
-				JOB_DISTRIBUTION, NUM_JOBS_PER_PROC, JOBPOOL_SEND_SIZE);
-		}
+		// Master acts differently depending on algorithm (Iterative deepening if there is a Timeout)
+		vector<point> validMoves = solver.getBestMoves(board, currentPlayer, maxDepth, numProcs, 
+			ALGORITHM, JOB_DISTRIBUTION, NUM_JOBS_PER_PROC, JOBPOOL_SEND_SIZE);
 
 		// Print best moves
 		if (validMoves.size() == 0) {
@@ -129,7 +234,10 @@ int main(int argc, char** argv) {
 		cout << "Algorithm: " << ALGORITHM << endl;
 	  	cout << "Job distribution: " << JOB_DISTRIBUTION << endl;
 	  	cout << "Number of Jobs per Processor: " << NUM_JOBS_PER_PROC << endl;
+	  	cout << "Job frontier per Processor: " << JOB_FRONTIER_PER_PROC << endl;
 	  	cout << "Job Pool Send size: " << JOBPOOL_SEND_SIZE << endl;
+	  	cout << "Group size: " << GROUP_SIZE << endl;
+	  	cout << "Number of Threads per Processor: " << getNumThreads() << endl;
 		cout << "Number of boards assessed: " << solver.getBoardsSearched() << endl << endl;
 
 	} else {
@@ -139,22 +247,61 @@ int main(int argc, char** argv) {
 		if (ALGORITHM.compare("SERIAL_MINIMAX") == 0) {
 			// Serial Algorithm: Do nothing
 
-		} else if (ALGORITHM.compare("SERIAL_ALPHABETA") == 0) {
+		} else if (ALGORITHM.compare("SERIAL_ALPHABETA") == 0 ||
+				   ALGORITHM.compare("SERIAL_PVS") == 0 ||
+				   ALGORITHM.compare("SERIAL_MTDF") == 0) {
 			// Serial Algorithm: Do nothing
 
 
+		/*********************** LAZY SMP ************************/
+		} else if (ALGORITHM.compare("SMP_ALPHABETA") == 0 ||
+				   ALGORITHM.compare("SMP_PVS") == 0) {
+			// Threads of Master only: Do nothing
+
+
 		/************** SENDING PROBLEMS AS A BATCH ***************/
 		} else if (ALGORITHM.compare("BATCH_MINIMAX") == 0 || 
-				   ALGORITHM.compare("BATCH_ALPHABETA") == 0) {
+				   ALGORITHM.compare("BATCH_ALPHABETA") == 0 ||
+				   ALGORITHM.compare("BATCH_PVS") == 0) {
 			slaveWaitForJob(ALGORITHM, id);
 
 
 		/********************** JOB POOLING ***********************/
 		} else if (ALGORITHM.compare("JOBPOOL_MINIMAX") == 0 ||
-				   ALGORITHM.compare("JOBPOOL_ALPHABETA") == 0) {
+				   ALGORITHM.compare("JOBPOOL_ALPHABETA") == 0 ||
+				   ALGORITHM.compare("JOBPOOL_PVS") == 0) {
+			slaveRequestJob(ALGORITHM, id);
+
+
+		/************** YOUNG BROTHERS WAIT CONCEPT ***************/
+		} else if (ALGORITHM.compare("YBWC_ALPHABETA") == 0) {
 			slaveRequestJob(ALGORITHM, id);
+
+
+		/********************* WORK STEALING **********************/
+		} else if (ALGORITHM.compare("STEALING_MINIMAX") == 0 ||
+				   ALGORITHM.compare("STEALING_ALPHABETA") == 0 ||
+				   ALGORITHM.compare("STEALING_PVS") == 0) {
+			slaveStealJobs(ALGORITHM, id);
+
+
+		/***************** HIERARCHICAL JOB POOLING ***************/
+		} else if (ALGORITHM.compare("HIERARCHICAL_MINIMAX") == 0 ||
+				   ALGORITHM.compare("HIERARCHICAL_ALPHABETA") == 0 ||
+				   ALGORITHM.compare("HIERARCHICAL_PVS") == 0) {
+			slaveJoinGroup(ALGORITHM, id, GROUP_SIZE, JOB_DISTRIBUTION, NUM_JOBS_PER_PROC, JOBPOOL_SEND_SIZE);
+
+
+		/****************** ONE-SIDED JOB QUEUE *******************/
+		} else if (ALGORITHM.compare("RMA_MINIMAX") == 0 ||
+				   ALGORITHM.compare("RMA_ALPHABETA") == 0 ||
+				   ALGORITHM.compare("RMA_PVS") == 0) {
+			slaveClaimJobs(ALGORITHM, id);
 		} 
 	}
 
+	freeDistributedTable();
+	freeTranspositionTable();
+	delete config;
 	MPI_Finalize();
 }
\ No newline at end of file
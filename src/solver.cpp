@@ -1,11 +1,178 @@
-
 #include "solver.h"
+#include "wire.h"
 
 using namespace std;
 
 
+/******************************* ITERATIVE DEEPENING *******************************/
+
+/*
+ * Entry point of the Master: Gets the best moves using the algorithm.
+ *
+ * If there is a Timeout, the algorithm is run at depth 1, 2, 3... up to depth, and the best 
+ * moves of the last depth that completed before the Timeout are returned.
+ */
+vector<point> Solver::getBestMoves(Board board, int player, int depth, int numProcs,
+	string algorithm, string jobDistribution, int numJobsPerProc, int jobPoolSendSize) {
+	vector<point> bestMoves = board.getValidMoves(player);
+	bool parallel = (algorithm.find("BATCH_") == 0 || algorithm.find("JOBPOOL_") == 0 || 
+		algorithm.find("YBWC_") == 0 || algorithm.find("STEALING_") == 0 || 
+		algorithm.find("HIERARCHICAL_") == 0 || algorithm.find("RMA_") == 0);
+
+	// Hierarchical algorithms: Master runs the Job pool with the Sub-masters only (See joinGroups)
+	if (algorithm.find("HIERARCHICAL_") == 0) {
+		numProcs = masterJoinGroups();
+	}
+
+	// Parallel algorithms: Tell the Slaves the parameters of the search
+	if (parallel) {
+		masterSendSession(numProcs, width, height, maxBoards, cornerValue, edgeValue, tableSize);
+	}
+
+	if (timeout <= 0) {
+		bestMoves = getMoves(board, player, depth, numProcs, 
+			algorithm, jobDistribution, numJobsPerProc, jobPoolSendSize);
+
+	} else if (bestMoves.size() > 1) {
+		// If no depth completes in time, fall back to the first valid move
+		bestMoves.erase(bestMoves.begin() + 1, bestMoves.end());
+		deadline = wallClockTime() + timeout * 1000000000LL;
+
+		// Searching deeper than the number of empty cells will not change the result
+		int lastDepth = min(depth, board.getNumEmpty());
+		for (int d = 1; d <= lastDepth; d++) {
+			long long before = wallClockTime();
+			vector<point> moves = getMoves(board, player, d, numProcs, 
+				algorithm, jobDistribution, numJobsPerProc, jobPoolSendSize);
+			long long after = wallClockTime();
+
+			if (timedOut || after >= deadline) {
+				printf("=== Depth %2d: TIMED OUT after %6.2f s ===\n", d, (after - before) / 1000000000.0);
+				break;
+			}
+			printf("=== Depth %2d: Completed in %6.2f s ===\n", d, (after - before) / 1000000000.0);
+			bestMoves = moves;
+		}
+		deadline = 0;
+		timedOut = false;
+	}
+
+	// Parallel algorithms: Tell the Slaves that there are no more searches
+	if (parallel) {
+		masterNotifySlaves(numProcs, MASTER_NO_JOBS);
+	}
+	return bestMoves;
+}
+
+// Gets the best moves using the algorithm searching to a fixed depth
+vector<point> Solver::getMoves(Board board, int player, int depth, int numProcs,
+	string algorithm, string jobDistribution, int numJobsPerProc, int jobPoolSendSize) {
+	/************************* SERIAL *************************/
+	if (algorithm.compare("SERIAL_MINIMAX") == 0) {
+		return getMinimaxMoves(board, player, depth);
+
+	} else if (algorithm.compare("SERIAL_ALPHABETA") == 0) {
+		return getAlphaBetaMoves(board, player, depth);
+
+	} else if (algorithm.compare("SERIAL_PVS") == 0) {
+		return getPVSMoves(board, player, depth);
+
+	} else if (algorithm.compare("SERIAL_MTDF") == 0) {
+		return getMTDFMoves(board, player, depth);
+
+
+	/************** SENDING PROBLEMS AS A BATCH ***************/
+	} else if (algorithm.compare("BATCH_MINIMAX") == 0 || 
+			   algorithm.compare("BATCH_ALPHABETA") == 0 ||
+			   algorithm.compare("BATCH_PVS") == 0) {
+		return getBatchMoves(board, player, depth, numProcs, 
+			algorithm, jobDistribution, numJobsPerProc);
+
+
+	/********************** JOB POOLING ***********************/ 
+	} else if (algorithm.compare("JOBPOOL_MINIMAX") == 0 ||
+			   algorithm.compare("JOBPOOL_ALPHABETA") == 0 ||
+			   algorithm.compare("JOBPOOL_PVS") == 0 ||
+			   algorithm.compare("HIERARCHICAL_MINIMAX") == 0 ||
+			   algorithm.compare("HIERARCHICAL_ALPHABETA") == 0 ||
+			   algorithm.compare("HIERARCHICAL_PVS") == 0) {
+		return getJobPoolMoves(board, player, depth, numProcs, 
+			algorithm, jobDistribution, numJobsPerProc, jobPoolSendSize);
+
+
+	/************** YOUNG BROTHERS WAIT CONCEPT ***************/ 
+	} else if (algorithm.compare("YBWC_ALPHABETA") == 0) {
+		return getYBWCMoves(board, player, depth, numProcs, numJobsPerProc);
+
+
+	/********************* WORK STEALING **********************/ 
+	} else if (algorithm.compare("STEALING_MINIMAX") == 0 ||
+			   algorithm.compare("STEALING_ALPHABETA") == 0 ||
+			   algorithm.compare("STEALING_PVS") == 0) {
+		return getWorkStealingMoves(board, player, depth, numProcs, algorithm, numJobsPerProc);
+
+
+	/*********************** LAZY SMP ************************/ 
+	} else if (algorithm.compare("SMP_ALPHABETA") == 0 ||
+			   algorithm.compare("SMP_PVS") == 0) {
+		return getLazySMPMoves(board, player, depth, algorithm);
+
+
+	/****************** ONE-SIDED JOB QUEUE *******************/ 
+	} else if (algorithm.compare("RMA_MINIMAX") == 0 ||
+			   algorithm.compare("RMA_ALPHABETA") == 0 ||
+			   algorithm.compare("RMA_PVS") == 0) {
+		return getRMAMoves(board, player, depth, numProcs, algorithm, numJobsPerProc);
+	}
+	return vector<point>();
+}
+
+// Sets the time at which searches have to stop (0 for no limit)
+void Solver::setDeadline(long long d) {
+	deadline = d;
+	timedOut = false;
+}
+
+// Searches return immediately once this is true
+// (Also true once Master has aborted the Job being searched)
+bool Solver::isOutOfTime() {
+	if (timedOut || (deadline == 0 && abortableJob < 0 && stopSearch == NULL)) {
+		return timedOut;
+	}
+	// Only check the clock and the messages every so often as they are expensive
+	timeChecks++;
+	if ((timeChecks & 1023) == 0) {
+		if (deadline != 0 && wallClockTime() >= deadline) {
+			timedOut = true;
+		} else if (abortableJob >= 0 && isJobAborted(abortableJob)) {
+			timedOut = true;
+		} else if (stopSearch != NULL && *stopSearch) {
+			timedOut = true;
+		}
+	}
+	return timedOut;
+}
+
+// Searches of the Job stop if Master aborts it (-1 if the search cannot be aborted)
+void Solver::setAbortableJob(int jobId) {
+	abortableJob = jobId;
+}
+
+// Searches stop once the flag is set by another thread (NULL if the search cannot be stopped)
+void Solver::setStopFlag(atomic<bool>* stop) {
+	stopSearch = stop;
+}
+
+
 /******************************* PARALLEL ALGORITHMS *******************************/
 
+// Time of a parallel search on Master
+void Solver::printMasterTime(long long startTime, long long commTime, long long compTime) {
+	long long totalTime = wallClockTime() - startTime;
+	printf("\n --- MASTER: Commmunication = %6.2f s, Computation = %6.2f s\n", commTime / 1000000000.0, compTime / 1000000000.0);
+	printf("     [TOTAL TIME TAKEN: %6.2f s]\n\n", totalTime / 1000000000.0);
+}
+
 /*
  * Parallel version of getMinimaxMoves
  *
@@ -22,10 +189,8 @@ vector<point> Solver::getBatchMoves(Board board, int player, int depth, int numP
 
 	vector<point> validMoves = board.getValidMoves(player);
 	if (validMoves.size() == 0) {
-		masterNotifySlaves(numProcs, MASTER_NO_JOBS);
 		return vector<point>();
 	} else if (validMoves.size() == 1) {
-		masterNotifySlaves(numProcs, MASTER_NO_JOBS);
 		return validMoves;
 	}
 	
@@ -38,24 +203,25 @@ vector<point> Solver::getBatchMoves(Board board, int player, int depth, int numP
 	deque<CompletedJob> waitingJobs;
 	before = wallClockTime();
 	masterInitialiseJobs(&jobs, &boards, &waitingJobs, validMoves, 
-		board, player, depth, maxBoards, cornerValue, edgeValue);
+		board, player, depth, maxBoards, cornerValue, edgeValue, tableSize);
 
 	// Split original Jobs into more Jobs before sending to divide more evenly
 	printf("=== Problem Size BEFORE splitting: %lu ===\n", jobs.size());
 	splitJobs(&jobs, &boards, &waitingJobs, numProcs, numJobsPerProc);
+	masterOrderJobs(&jobs, &boards, jobDistribution);
 	after = wallClockTime();
 	compTime += after - before;
 	printf("=== Problem Size AFTER splitting: %lu ===\n", jobs.size());
 
 	// Send Jobs to Slaves
 	before = wallClockTime();
-	masterSendBatchJobs(&jobs, &boards, numProcs, jobDistribution);
+	masterSendBatchJobs(&jobs, &boards, numProcs, jobDistribution, deadline);
 	after = wallClockTime();
 	commTime += after - before;
 
 	// Master to work on remaining Jobs
 	before = wallClockTime();
-	masterWorkOnJobs(algorithm, &jobs, &boards, &waitingJobs);
+	masterWorkOnJobs(algorithm, &jobs, &boards, &waitingJobs, deadline);
 	after = wallClockTime();
 	compTime += after - before;
 	printf(" --- MASTER FINISHED COMPUTATIONAL JOBS: Computation =%6.2f s\n", compTime / 1000000000.0);
@@ -73,41 +239,103 @@ vector<point> Solver::getBatchMoves(Board board, int player, int depth, int numP
 	compTime += after - before;
 
 	// Get the best moves
-	vector<point> minimaxMoves;
-	int bestValue = (player == BLACK) ? INT_MIN : INT_MAX;
-	for (int i = 0; i < waitingJobs.size(); i++) {
-		point validMove = validMoves[i];
-		int newValue = waitingJobs[i].moveValue;
-		boardsSearched += waitingJobs[i].boardsAssessed;
+	vector<point> minimaxMoves = masterGetBestMoves(&waitingJobs, validMoves, player, &boardsSearched);
+	printMasterTime(startTime, commTime, compTime);
 
-		if (player == BLACK && newValue > bestValue) {
-			// Clear previous moves
-			bestValue = newValue;
-			minimaxMoves.clear();
-			minimaxMoves.push_back(validMove);
+	return minimaxMoves;
+}
 
-		} else if (player == WHITE && newValue < bestValue) { 
-			// Clear previous moves
-			bestValue = newValue;
-			minimaxMoves.clear();
-			minimaxMoves.push_back(validMove);
+vector<point> Solver::getJobPoolMoves(Board board, int player, int depth, int numProcs, 
+	string algorithm, string jobDistribution, int numJobsPerProc, int jobPoolSendSize) {
+	// Timing
+	long long startTime = wallClockTime();
+	long long before, after;
+	long long commTime = 0;	// Communication
+	long long compTime = 0; // Computation
 
-		} else if (newValue == bestValue) {
-			// Add on to a previous move with same value
-			minimaxMoves.push_back(validMove);
+	vector<point> validMoves = board.getValidMoves(player);
+	if (validMoves.size() == 0) {
+		return vector<point>();
+	} else if (validMoves.size() == 1) {
+		return validMoves;
+	}
+
+	// Notify the Slaves that there are Jobs
+	masterNotifySlaves(numProcs, MASTER_SENDING_JOBS);
+
+	// Initialize jobs
+	deque<Job> jobs;
+	deque<Board> boards;
+	deque<CompletedJob> waitingJobs;
+	before = wallClockTime();
+	masterInitialiseJobs(&jobs, &boards, &waitingJobs, validMoves, 
+		board, player, depth, maxBoards, cornerValue, edgeValue, tableSize);
+
+	// Split original Jobs into more Jobs before sending to divide more evenly
+	printf("=== Problem Size BEFORE splitting: %lu ===\n", jobs.size());
+	splitJobs(&jobs, &boards, &waitingJobs, numProcs, getInitialJobsPerProc(numJobsPerProc));
+	masterOrderJobs(&jobs, &boards, jobDistribution);
+	after = wallClockTime();
+	compTime += after - before;
+	printf("=== Problem Size AFTER splitting: %lu ===\n", jobs.size());
+
+	// Results are combined as they arrive, so that Jobs are sent with the best window so far
+	masterInitialiseJobsLeft(&jobs, &waitingJobs);
+
+	// Handle Job requests from Slave processes until every Slave has been told there are no Jobs.
+	// Slaves request for their next Jobs before sending back their results, so the results of the
+	// Jobs that are still running have to be waited for as well.
+	JobPool pool = {&jobs, &boards, &waitingJobs, jobDistribution, jobPoolSendSize, deadline, 0, 0, 0, 
+		numProcs, numJobsPerProc, vector<deque<pair<int, long long> > >(numProcs), 
+		vector<long long>(numProcs, 0), vector<int>(numProcs, 0), vector<long long>(numProcs, 0)};
+	while (jobs.size() > 0 || pool.finishedSlaves < numProcs - 1 || pool.batchesRunning > 0) {
+
+		// Master works on a Job itself while no Slave is waiting for it (Requests that arrive 
+		// during the search are handled as it checks if the Job is still needed)
+		int waiting;
+		MPI_Iprobe(MPI_ANY_SOURCE, 0, jobComm, &waiting, MPI_STATUS_IGNORE);
+		if (!waiting && jobs.size() > 0) {
+			before = wallClockTime();
+			long long commTimeBefore = pool.commTime;
+			masterWorkOnJobPool(algorithm, &pool);
+			after = wallClockTime();
+			compTime += (after - before) - (pool.commTime - commTimeBefore);
+			continue;
 		}
+
+		MPI_Status status;
+		before = wallClockTime();
+		int request;
+		MPI_Recv(&request, 1, MPI_INT, MPI_ANY_SOURCE, 0, jobComm, &status);
+		after = wallClockTime();
+		commTime += after - before;
+
+		masterHandleRequest(&pool, status.MPI_SOURCE, request);
 	}
+	commTime += pool.commTime;
 
+	// Combine results from Slave processes
+	before = wallClockTime();
+	masterRewindMinimaxStack(&waitingJobs);
 	after = wallClockTime();
-	long long totalTime = after - startTime;
-	printf("\n --- MASTER: Commmunication = %6.2f s, Computation = %6.2f s\n", commTime / 1000000000.0, compTime / 1000000000.0);
-	printf("     [TOTAL TIME TAKEN: %6.2f s]\n\n", totalTime / 1000000000.0);
+	compTime += after - before;
+
+	// Get the best moves
+	vector<point> minimaxMoves = masterGetBestMoves(&waitingJobs, validMoves, player, &boardsSearched);
+	printMasterTime(startTime, commTime, compTime);
 
 	return minimaxMoves;
 }
 
-vector<point> Solver::getJobPoolMoves(Board board, int player, int depth, int numProcs, 
-	string jobDistribution, int numJobsPerProc, int jobPoolSendSize) {
+/*
+ * Parallel algorithm without a central pool of Jobs
+ *
+ * Master deals the Jobs out to all processes (itself included) once. Every process works on its 
+ * own Jobs and steals half of the Jobs of a random process once it has none left (See stealJobs).
+ * Results are sent to Master, which ends the search once it has the results of every Job.
+ */
+vector<point> Solver::getWorkStealingMoves(Board board, int player, int depth, int numProcs,
+	string algorithm, int numJobsPerProc) {
 	// Timing
 	long long startTime = wallClockTime();
 	long long before, after;
@@ -116,20 +344,21 @@ vector<point> Solver::getJobPoolMoves(Board board, int player, int depth, int nu
 
 	vector<point> validMoves = board.getValidMoves(player);
 	if (validMoves.size() == 0) {
-		masterNotifySlaves(numProcs, MASTER_NO_JOBS);
 		return vector<point>();
 	} else if (validMoves.size() == 1) {
-		masterNotifySlaves(numProcs, MASTER_NO_JOBS);
 		return validMoves;
 	}
 
+	// Notify the Slaves that there are Jobs
+	masterNotifySlaves(numProcs, MASTER_SENDING_JOBS);
+
 	// Initialize jobs
 	deque<Job> jobs;
 	deque<Board> boards;
 	deque<CompletedJob> waitingJobs;
 	before = wallClockTime();
 	masterInitialiseJobs(&jobs, &boards, &waitingJobs, validMoves, 
-		board, player, depth, maxBoards, cornerValue, edgeValue);
+		board, player, depth, maxBoards, cornerValue, edgeValue, tableSize);
 
 	// Split original Jobs into more Jobs before sending to divide more evenly
 	printf("=== Problem Size BEFORE splitting: %lu ===\n", jobs.size());
@@ -138,89 +367,332 @@ vector<point> Solver::getJobPoolMoves(Board board, int player, int depth, int nu
 	compTime += after - before;
 	printf("=== Problem Size AFTER splitting: %lu ===\n", jobs.size());
 
-	// Handle Job requests from Slave processes
-	int ongoingSlaves = 0;
-	while(jobs.size() > 0 || ongoingSlaves > 0) {
+	// Results are combined as they arrive
+	masterInitialiseJobsLeft(&jobs, &waitingJobs);
+	int numJobs = jobs.size();
 
-		MPI_Status status;
-		before = wallClockTime();
-		int request;
-		MPI_Recv(&request, 1, MPI_INT, MPI_ANY_SOURCE, 0, MPI_COMM_WORLD, &status);
-		after = wallClockTime();
-		commTime += after - before;
+	// Deal the Jobs out to every process
+	before = wallClockTime();
+	vector<vector<Job> > jobsToSend(numProcs);
+	vector<vector<Board> > boardsToSend(numProcs);
+	for (int i = 0; i < numJobs; i++) {
+		jobsToSend[i % numProcs].push_back(jobs[i]);
+		boardsToSend[i % numProcs].push_back(boards[i]);
+	}
+	for (int i = 1; i < numProcs; i++) {
+		masterSendJobList(&jobsToSend[i], &boardsToSend[i], i, deadline);
+	}
+	jobs.assign(jobsToSend[0].begin(), jobsToSend[0].end());
+	boards.assign(boardsToSend[0].begin(), boardsToSend[0].end());
+	after = wallClockTime();
+	commTime += after - before;
 
-		if (request == SLAVE_WANTS_JOBS && jobs.size() > 0) {
+	// Work on Jobs, steal Jobs and collect results until every Job is done
+	before = wallClockTime();
+	WorkStealing ws = {algorithm, 0, numProcs, &jobs, &boards, deadline, -1, false, &waitingJobs, numJobs};
+	stealJobs(&ws);
+	after = wallClockTime();
+	compTime += after - before;
+	printf(" --- MASTER FINISHED COMPUTATIONAL JOBS: Computation =%6.2f s\n", compTime / 1000000000.0);
 
-			// If there are Jobs, send those Jobs the Slaves are requesting for them
-			before = wallClockTime();
-			int response = MASTER_SENDING_JOBS;
-			MPI_Send(&response, 1, MPI_INT, status.MPI_SOURCE, 0, MPI_COMM_WORLD);
-			masterSendJobs(&jobs, &boards, status.MPI_SOURCE, jobPoolSendSize, jobDistribution);
-			ongoingSlaves++;
-			after = wallClockTime();
-			commTime += after - before;
+	// Combine results from all processes
+	before = wallClockTime();
+	masterRewindMinimaxStack(&waitingJobs);
+	after = wallClockTime();
+	compTime += after - before;
 
-		} else if (request == SLAVE_WANTS_JOBS && jobs.size() <= 0) {
+	// Get the best moves
+	vector<point> minimaxMoves = masterGetBestMoves(&waitingJobs, validMoves, player, &boardsSearched);
+	printMasterTime(startTime, commTime, compTime);
 
-			// If there are no more Jobs, inform the Slaves so that they will terminate
-			before = wallClockTime();
-			int response = MASTER_NO_JOBS;
-			MPI_Send(&response, 1, MPI_INT, status.MPI_SOURCE, 0, MPI_COMM_WORLD);
-			after = wallClockTime();
-			commTime += after - before;
+	return minimaxMoves;
+}
 
-		} else if (request == SLAVE_SENDING_JOBS) {
+/*
+ * Job pool without requests to Master
+ *
+ * Master packs the Jobs into a window (See JobQueue). Every process, Master included, claims the 
+ * next Job with an atomic increment, reads it and writes its result back with one-sided 
+ * communication, so no process waits for Master to hand out Jobs.
+ */
+vector<point> Solver::getRMAMoves(Board board, int player, int depth, int numProcs,
+	string algorithm, int numJobsPerProc) {
+	// Timing
+	long long startTime = wallClockTime();
+	long long before, after;
+	long long commTime = 0;	// Communication
+	long long compTime = 0; // Computation
 
-			// Collect results from Slaves
-			before = wallClockTime();
-			masterReceiveCompletedJobsFromSlave(&waitingJobs, status.MPI_SOURCE);
-			ongoingSlaves--;
-			after = wallClockTime();
-			commTime += after - before;
-		}
+	vector<point> validMoves = board.getValidMoves(player);
+	if (validMoves.size() == 0) {
+		return vector<point>();
+	} else if (validMoves.size() == 1) {
+		return validMoves;
 	}
-	// Tell the last Slave to stop working
+
+	// Notify the Slaves that there are Jobs
+	masterNotifySlaves(numProcs, MASTER_SENDING_JOBS);
+
+	// Initialize jobs
+	deque<Job> jobs;
+	deque<Board> boards;
+	deque<CompletedJob> waitingJobs;
 	before = wallClockTime();
-	MPI_Status status;
-	int request;
-	int response = MASTER_NO_JOBS;
-	MPI_Recv(&request, 1, MPI_INT, MPI_ANY_SOURCE, 0, MPI_COMM_WORLD, &status);
-	MPI_Send(&response, 1, MPI_INT, status.MPI_SOURCE, 0, MPI_COMM_WORLD);
+	masterInitialiseJobs(&jobs, &boards, &waitingJobs, validMoves, 
+		board, player, depth, maxBoards, cornerValue, edgeValue, tableSize);
+
+	// Split original Jobs into more Jobs before sending to divide more evenly
+	printf("=== Problem Size BEFORE splitting: %lu ===\n", jobs.size());
+	splitJobs(&jobs, &boards, &waitingJobs, numProcs, numJobsPerProc);
+	printf("=== Problem Size AFTER splitting: %lu ===\n", jobs.size());
+
+	// Pack every Job on its own, so that each Job can be read at its own offset
+	vector<uint8_t> packedJobs;
+	int jobSize = 0;
+	for (int k = 0; k < jobs.size(); k++) {
+		vector<Job> jobToPack(1, jobs[k]);
+		vector<Board> boardToPack(1, boards[k]);
+		vector<uint8_t> message;
+		packJobs(&message, &jobToPack, &boardToPack, 0);
+		jobSize = message.size();
+		packedJobs.insert(packedJobs.end(), message.begin(), message.end());
+	}
 	after = wallClockTime();
-	commTime += after - before;
+	compTime += after - before;
 
-	// Combine results from Slave processes
+	// Claim Jobs together with the Slaves
 	before = wallClockTime();
+	JobQueue queue;
+	vector<CompletedJob> completedJobs;
+	masterCreateJobQueue(&queue, &packedJobs, jobs.size(), jobSize, deadline);
+	claimJobs(algorithm, &queue);
+	freeJobQueue(&queue, &completedJobs);
+	after = wallClockTime();
+	compTime += after - before;
+	printf(" --- MASTER FINISHED COMPUTATIONAL JOBS: Computation =%6.2f s\n", compTime / 1000000000.0);
+
+	// Combine results from all processes
+	before = wallClockTime();
+	for (int k = 0; k < completedJobs.size(); k++) {
+		waitingJobs[completedJobs[k].id].moveValue = completedJobs[k].moveValue;
+		waitingJobs[completedJobs[k].id].boardsAssessed += completedJobs[k].boardsAssessed;
+	}
 	masterRewindMinimaxStack(&waitingJobs);
 	after = wallClockTime();
 	compTime += after - before;
 
 	// Get the best moves
-	vector<point> minimaxMoves;
-	int bestValue = (player == BLACK) ? INT_MIN : INT_MAX;
-	for (int i = 0; i < waitingJobs.size(); i++) {
-		point validMove = validMoves[i];
-		int newValue = waitingJobs[i].moveValue;
-		boardsSearched += waitingJobs[i].boardsAssessed;
+	vector<point> minimaxMoves = masterGetBestMoves(&waitingJobs, validMoves, player, &boardsSearched);
+	printMasterTime(startTime, commTime, compTime);
 
-		if (player == BLACK && newValue > bestValue) {
-			// Clear previous moves
-			bestValue = newValue;
-			minimaxMoves.clear();
-			minimaxMoves.push_back(validMove);
+	return minimaxMoves;
+}
 
-		} else if (player == WHITE && newValue < bestValue) { 
-			// Clear previous moves
-			bestValue = newValue;
-			minimaxMoves.clear();
-			minimaxMoves.push_back(validMove);
+/*
+ * Lazy SMP: Threads of Master search the same tree and share the transposition table
+ *
+ * Helper threads start from different root moves and order moves slightly differently, so they
+ * fill the table with the values of other subtrees than the main thread. The main thread runs the
+ * serial algorithm and finds these values in the table. Its result is the result of the search, 
+ * and the helpers stop once it is done.
+ */
+vector<point> Solver::getLazySMPMoves(Board board, int player, int depth, string algorithm) {
+	string serialAlgorithm = (algorithm.compare("SMP_PVS") == 0) ? "SERIAL_PVS" : "SERIAL_ALPHABETA";
+	int numHelpers = getNumThreads() - 1;
+	if (table == NULL || numHelpers == 0) {
+		return getMoves(board, player, depth, 1, serialAlgorithm, "", 0, 0);
+	}
 
-		} else if (newValue == bestValue) {
-			// Add on to a previous move with same value
-			minimaxMoves.push_back(validMove);
+	startSearch();
+	searchStarted = true;
+
+	atomic<bool> stop(false);
+	vector<Solver*> helpers;
+	vector<thread> threads;
+	for (int i = 1; i <= numHelpers; i++) {
+		Solver* helper = new Solver(width, height, maxDepth, maxBoards, cornerValue, edgeValue);
+		helper->setTranspositionTable(table);
+		helper->setDeadline(deadline);
+		helper->setStopFlag(&stop);
+		helper->perturbMoveOrdering(i);
+		helpers.push_back(helper);
+		threads.push_back(thread(&Solver::searchLazySMPHelper, helper, board, player, depth, serialAlgorithm, i));
+	}
+
+	vector<point> minimaxMoves = getMoves(board, player, depth, 1, serialAlgorithm, "", 0, 0);
+	searchStarted = false;
+
+	stop = true;
+	for (int i = 0; i < numHelpers; i++) {
+		threads[i].join();
+		boardsSearched += helpers[i]->getBoardsSearched();
+		delete helpers[i];
+	}
+	return minimaxMoves;
+}
+
+// Search of a helper thread of Lazy SMP, the values are only kept in the transposition table
+void Solver::searchLazySMPHelper(Board board, int player, int depth, string algorithm, int helperId) {
+	vector<point> validMoves = board.getValidMoves(player);
+	if (validMoves.size() <= 1) {
+		return;
+	}
+	rotate(validMoves.begin(), validMoves.begin() + helperId % validMoves.size(), validMoves.end());
+
+	for (point validMove : validMoves) {
+		board.makeMove(player, validMove.x, validMove.y);
+		if (algorithm.compare("SERIAL_PVS") == 0) {
+			getPVSValue(-INT_MAX, INT_MAX, board, OPP(player), depth - 1);
+		} else if (player == BLACK) {
+			getAlphaBetaMinValue(INT_MIN, INT_MAX, board, OPP(player), depth - 1);
+		} else {
+			getAlphaBetaMaxValue(INT_MIN, INT_MAX, board, OPP(player), depth - 1);
+		}
+		board.undoMove();
+
+		if (timedOut) {
+			return;
+		}
+	}
+}
+
+/*
+ * Parallel alpha-beta pruning with the Young Brothers Wait Concept
+ *
+ * Master splits the top of the game tree into Jobs (See JobTree). Slaves request for Jobs like 
+ * in the Job pool, but the younger brothers of a node are only sent out once the eldest brother
+ * is done, with the window given by the values found so far. Slaves that request for Jobs while
+ * all the Jobs are waiting are answered once a Job can be sent, Slaves that have no Job first.
+ */
+vector<point> Solver::getYBWCMoves(Board board, int player, int depth, int numProcs, int numJobsPerProc) {
+	// Timing
+	long long startTime = wallClockTime();
+	long long before, after;
+	long long commTime = 0;	// Communication
+	long long compTime = 0; // Computation
+
+	vector<point> validMoves = board.getValidMoves(player);
+	if (validMoves.size() == 0) {
+		return vector<point>();
+	} else if (validMoves.size() == 1) {
+		return validMoves;
+	} else if (numProcs < 2) {
+		// No Slaves to send Jobs to
+		return getAlphaBetaMoves(board, player, depth);
+	}
+
+	// Notify the Slaves that there are Jobs
+	masterNotifySlaves(numProcs, MASTER_SENDING_JOBS);
+
+	startSearch();
+
+	// Split the top of the tree into Jobs
+	before = wallClockTime();
+	JobTree tree = JobTree(this, board, player, depth);
+	tree.split(numProcs * min(MAX_JOBS_PER_PROC, numJobsPerProc));
+	after = wallClockTime();
+	compTime += after - before;
+	printf("=== Problem Size AFTER splitting: %d ===\n", tree.getNumLeaves());
+
+	// Handle Job requests from Slave processes until every Slave has been told there are no Jobs,
+	// and the results of the Jobs that are still running have been received
+	deque<int> idleSlaves;
+	int finishedSlaves = 0;
+	int jobsRunning = 0;
+	vector<int> slaveJobs(numProcs, 0);
+	while (finishedSlaves < numProcs - 1 || jobsRunning > 0) {
+		MPI_Status status;
+		before = wallClockTime();
+		int request;
+		MPI_Recv(&request, 1, MPI_INT, MPI_ANY_SOURCE, 0, jobComm, &status);
+		after = wallClockTime();
+		commTime += after - before;
+
+		// Values of Jobs that ran out of time are not correct
+		if (deadline > 0 && wallClockTime() >= deadline) {
+			timedOut = true;
 		}
+
+		if (request == SLAVE_WANTS_JOBS) {
+			idleSlaves.push_back(status.MPI_SOURCE);
+
+		} else if (request == SLAVE_SENDING_JOBS) {
+
+			// Collect results from Slaves, which may allow younger brothers to be sent
+			before = wallClockTime();
+			vector<CompletedJob> completedJobs;
+			masterReceiveCompletedJobList(&completedJobs, status.MPI_SOURCE);
+			jobsRunning--;
+			slaveJobs[status.MPI_SOURCE]--;
+			for (int i = 0; i < completedJobs.size(); i++) {
+				if (!timedOut) {
+					tree.completeJob(completedJobs[i].id, completedJobs[i].moveValue);
+				}
+				boardsSearched += completedJobs[i].boardsAssessed;
+			}
+			after = wallClockTime();
+			commTime += after - before;
+		}
+
+		// Send the Jobs that can be searched now to the idle Slaves
+		before = wallClockTime();
+		while (idleSlaves.size() > 0) {
+			// Slaves that are not searching a Job get Jobs before Slaves that request in advance
+			int index = 0;
+			for (int i = 0; i < idleSlaves.size(); i++) {
+				if (slaveJobs[idleSlaves[i]] == 0) {
+					index = i;
+					break;
+				}
+			}
+			int slave = idleSlaves[index];
+
+			if (tree.isDone() || timedOut) {
+				int response = MASTER_NO_JOBS;
+				MPI_Send(&response, 1, MPI_INT, slave, 0, jobComm);
+				idleSlaves.erase(idleSlaves.begin() + index);
+				finishedSlaves++;
+				continue;
+			}
+
+			int id = tree.getNextJob();
+			if (id < 0) {
+				// Wait for the Jobs that are being searched
+				break;
+			}
+			tree.setRunning(id, slave);
+
+			JobNode* node = tree.getNode(id);
+			int alpha, beta;
+			tree.getWindow(id, &alpha, &beta);
+			Job job = {
+				id, node->parent, width, height, maxBoards, cornerValue, edgeValue, tableSize,
+				node->player, node->depthLeft, 0, alpha, beta, 0, NULL, 0
+			};
+			vector<Job> jobsToSend(1, job);
+			vector<Board> boardsToSend(1, node->board);
+
+			int response = MASTER_SENDING_JOBS;
+			MPI_Send(&response, 1, MPI_INT, slave, 0, jobComm);
+			masterSendJobList(&jobsToSend, &boardsToSend, slave, deadline);
+			idleSlaves.erase(idleSlaves.begin() + index);
+			jobsRunning++;
+			slaveJobs[slave]++;
+		}
+
+		// Slaves stop searching the Jobs that are no longer needed
+		vector<int> abandoned = tree.abandonJobs();
+		for (int i = 0; i < abandoned.size(); i++) {
+			masterAbortJob(tree.getNode(abandoned[i])->slave, abandoned[i]);
+		}
+		after = wallClockTime();
+		commTime += after - before;
 	}
 
+	// Boards assessed when splitting
+	boardsSearched += tree.getNumNodes() - 1;
+	vector<point> minimaxMoves = tree.getBestMoves();
+
 	after = wallClockTime();
 	long long totalTime = after - startTime;
 	printf("\n --- MASTER: Commmunication = %6.2f s, Computation = %6.2f s\n", commTime / 1000000000.0, compTime / 1000000000.0);
@@ -247,10 +719,10 @@ vector<point> Solver::getMinimaxMoves(Board board, int player, int depth) {
 
 	int value = (player == BLACK) ? INT_MIN : INT_MAX;
 	for (point validMove : validMoves) {
-		Board newBoard = board;
-		newBoard.makeMove(player, validMove.x, validMove.y);
-		int newValue = (player == BLACK) ? getMinValue(newBoard, OPP(player), depth - 1) :
-										   getMaxValue(newBoard, OPP(player), depth - 1);
+		board.makeMove(player, validMove.x, validMove.y);
+		int newValue = (player == BLACK) ? getMinValue(board, OPP(player), depth - 1) :
+										   getMaxValue(board, OPP(player), depth - 1);
+		board.undoMove();
 
 		if (player == BLACK && newValue > value) {
 			// Clear previous moves
@@ -277,7 +749,12 @@ vector<point> Solver::getMinimaxMoves(Board board, int player, int depth) {
 	return minimaxMoves;
 }
 
-int Solver::getMinValue(Board board, int player, int depth) {
+int Solver::getMinValue(Board& board, int player, int depth) {
+	// Value does not matter as the search will be discarded
+	if (isOutOfTime()) {
+		return 0;
+	}
+
 	// Evaluate boards
 	if (board.isGameOver()) {
 		return evaluateBoard(board);
@@ -285,7 +762,8 @@ int Solver::getMinValue(Board board, int player, int depth) {
 		return evaluateDepthLimitedBoard(board);
 	}
 
-	vector<point> validMoves = board.getValidMoves(player);
+	vector<point>& validMoves = getMoveList(depth);
+	board.getValidMoves(player, validMoves);
 	if (validMoves.size() == 0) {
 		// Skip to next player if no moves
 		return getMaxValue(board, OPP(player), depth);
@@ -294,16 +772,20 @@ int Solver::getMinValue(Board board, int player, int depth) {
 	int value = INT_MAX;
 	for (point validMove : validMoves) {
 		boardsSearched++;
-		Board newBoard = board;
-		newBoard.makeMove(player, validMove.x, validMove.y);
-
-		int newValue = getMaxValue(newBoard, OPP(player), depth - 1);
+		board.makeMove(player, validMove.x, validMove.y);
+		int newValue = getMaxValue(board, OPP(player), depth - 1);
+		board.undoMove();
 		value = min(value, newValue);
 	}
 	return value;
 }
 
-int Solver::getMaxValue(Board board, int player, int depth) {
+int Solver::getMaxValue(Board& board, int player, int depth) {
+	// Value does not matter as the search will be discarded
+	if (isOutOfTime()) {
+		return 0;
+	}
+
 	// Evaluate boards
 	if (board.isGameOver()) {
 		return evaluateBoard(board);
@@ -311,7 +793,8 @@ int Solver::getMaxValue(Board board, int player, int depth) {
 		return evaluateDepthLimitedBoard(board);
 	}
 
-	vector<point> validMoves = board.getValidMoves(player);
+	vector<point>& validMoves = getMoveList(depth);
+	board.getValidMoves(player, validMoves);
 	if (validMoves.size() == 0) {
 		// Skip to next player if no moves
 		return getMinValue(board, OPP(player), depth);
@@ -320,10 +803,9 @@ int Solver::getMaxValue(Board board, int player, int depth) {
 	int value = INT_MIN;
 	for (point validMove : validMoves) {
 		boardsSearched++;
-		Board newBoard = board;
-		newBoard.makeMove(player, validMove.x, validMove.y);
-
-		int newValue = getMinValue(newBoard, OPP(player), depth - 1);
+		board.makeMove(player, validMove.x, validMove.y);
+		int newValue = getMinValue(board, OPP(player), depth - 1);
+		board.undoMove();
 		value = max(value, newValue);
 	}
 	return value;
@@ -335,6 +817,8 @@ vector<point> Solver::getAlphaBetaMoves(Board board, int player, int depth) {
 	long long startTime = wallClockTime();
 	long long after;
 
+	startSearch();
+
 	vector<point> validMoves = board.getValidMoves(player);
 	if (validMoves.size() == 0) {
 		return vector<point>();
@@ -345,10 +829,10 @@ vector<point> Solver::getAlphaBetaMoves(Board board, int player, int depth) {
 
 	int value = (player == BLACK) ? INT_MIN : INT_MAX;
 	for (point validMove : validMoves) {
-		Board newBoard = board;
-		newBoard.makeMove(player, validMove.x, validMove.y);
-		int newValue = (player == BLACK) ? getAlphaBetaMinValue(INT_MIN, INT_MAX, newBoard, OPP(player), depth - 1)
-										 : getAlphaBetaMaxValue(INT_MIN, INT_MAX, newBoard, OPP(player), depth - 1);
+		board.makeMove(player, validMove.x, validMove.y);
+		int newValue = (player == BLACK) ? getAlphaBetaMinValue(INT_MIN, INT_MAX, board, OPP(player), depth - 1)
+										 : getAlphaBetaMaxValue(INT_MIN, INT_MAX, board, OPP(player), depth - 1);
+		board.undoMove();
 
 		if (player == BLACK && newValue > value) {
 			// Clear previous moves
@@ -375,7 +859,12 @@ vector<point> Solver::getAlphaBetaMoves(Board board, int player, int depth) {
 	return minimaxMoves;
 }
 
-int Solver::getAlphaBetaMinValue(int alpha, int beta, Board board, int player, int depth) {
+int Solver::getAlphaBetaMinValue(int alpha, int beta, Board& board, int player, int depth) {
+	// Value does not matter as the search will be discarded
+	if (isOutOfTime()) {
+		return 0;
+	}
+
 	// Evaluate boards
 	if (board.isGameOver()) {
 		return evaluateBoard(board);
@@ -383,31 +872,52 @@ int Solver::getAlphaBetaMinValue(int alpha, int beta, Board board, int player, i
 		return evaluateDepthLimitedBoard(board);
 	}
 
-	vector<point> validMoves = board.getValidMoves(player);
+	// Reuse the value if this position has already been searched (through another move order)
+	uint64_t hash = board.getHash(player);
+	int value, hashMove;
+	if (probeTranspositionTable(hash, alpha, beta, depth, &value, &hashMove)) {
+		return value;
+	}
+
+	vector<point>& validMoves = getMoveList(depth);
+	board.getValidMoves(player, validMoves);
 	if (validMoves.size() == 0) {
 		// Skip to next player if no moves
 		return getAlphaBetaMaxValue(alpha, beta, board, OPP(player), depth);
 	}
+	orderMoves(validMoves, player, depth, hashMove);
+	prefetchChildren(board, validMoves, player, depth);
 
-	int value = INT_MAX;
+	int betaOriginal = beta;
+	int bestMove = -1;
+	value = INT_MAX;
 	for (point validMove : validMoves) {
 		boardsSearched++;
-		Board newBoard = board;
-		newBoard.makeMove(player, validMove.x, validMove.y);
-
-		int newValue = getAlphaBetaMaxValue(alpha, beta, newBoard, OPP(player), depth - 1);
-		value = min(value, newValue);
+		board.makeMove(player, validMove.x, validMove.y);
+		int newValue = getAlphaBetaMaxValue(alpha, beta, board, OPP(player), depth - 1);
+		board.undoMove();
+		if (newValue < value) {
+			value = newValue;
+			bestMove = validMove.x * height + validMove.y;
+		}
 
 		// Pruning
 		if (value <= alpha) {
-			return value;
+			recordCutoff(player, depth, bestMove);
+			break;
 		}
 		beta = min(beta, value);
 	}
+	storeTranspositionTable(hash, alpha, betaOriginal, depth, value, bestMove);
 	return value;
 }
 
-int Solver::getAlphaBetaMaxValue(int alpha, int beta, Board board, int player, int depth) {
+int Solver::getAlphaBetaMaxValue(int alpha, int beta, Board& board, int player, int depth) {
+	// Value does not matter as the search will be discarded
+	if (isOutOfTime()) {
+		return 0;
+	}
+
 	// Evaluate boards
 	if (board.isGameOver()) {
 		return evaluateBoard(board);
@@ -415,76 +925,449 @@ int Solver::getAlphaBetaMaxValue(int alpha, int beta, Board board, int player, i
 		return evaluateDepthLimitedBoard(board);
 	}
 
-	vector<point> validMoves = board.getValidMoves(player);
+	// Reuse the value if this position has already been searched (through another move order)
+	uint64_t hash = board.getHash(player);
+	int value, hashMove;
+	if (probeTranspositionTable(hash, alpha, beta, depth, &value, &hashMove)) {
+		return value;
+	}
+
+	vector<point>& validMoves = getMoveList(depth);
+	board.getValidMoves(player, validMoves);
 	if (validMoves.size() == 0) {
 		// Skip to next player if no moves
 		return getAlphaBetaMinValue(alpha, beta, board, OPP(player), depth);
 	}
+	orderMoves(validMoves, player, depth, hashMove);
+	prefetchChildren(board, validMoves, player, depth);
 
-	int value = INT_MIN;
+	int alphaOriginal = alpha;
+	int bestMove = -1;
+	value = INT_MIN;
 	for (point validMove : validMoves) {
 		boardsSearched++;
-		Board newBoard = board;
-		newBoard.makeMove(player, validMove.x, validMove.y);
-
-		int newValue = getAlphaBetaMinValue(alpha, beta, newBoard, OPP(player), depth - 1);
-		value = max(value, newValue);
+		board.makeMove(player, validMove.x, validMove.y);
+		int newValue = getAlphaBetaMinValue(alpha, beta, board, OPP(player), depth - 1);
+		board.undoMove();
+		if (newValue > value) {
+			value = newValue;
+			bestMove = validMove.x * height + validMove.y;
+		}
 
 		// Pruning
 		if (value >= beta) {
-			return value;
+			recordCutoff(player, depth, bestMove);
+			break;
 		}
 		alpha = max(alpha, value);
 	}
+	storeTranspositionTable(hash, alphaOriginal, beta, depth, value, bestMove);
 	return value;
 }
 
-int Solver::evaluateBoard(Board board) {
-	int scoreWhite = 0;
-	int scoreBlack = 0;
-	for (int i = 0; i < width; i++) {
-		for (int j = 0; j < height; j++) {
-			if (board.getDisk(i, j) == WHITE) {
-				scoreWhite++;
-			} else if (board.getDisk(i, j) == BLACK) {
-				scoreBlack++;
+/*
+ * Principal variation search (Negamax form): Values are from the perspective of the player to move.
+ *
+ * The first move is searched with the full window. The other moves are only searched with a null 
+ * window to prove that they are not better than the best move so far, and are searched again with 
+ * the full window if they are.
+ */
+vector<point> Solver::getPVSMoves(Board board, int player, int depth) {
+	// Timing
+	long long startTime = wallClockTime();
+	long long after;
+
+	startSearch();
+
+	vector<point> validMoves = board.getValidMoves(player);
+	if (validMoves.size() == 0) {
+		return vector<point>();
+	} else if (validMoves.size() == 1) {
+		return validMoves;
+	}
+	vector<point> minimaxMoves;
+
+	int value = -INT_MAX;
+	for (int i = 0; i < validMoves.size(); i++) {
+		point validMove = validMoves[i];
+		board.makeMove(player, validMove.x, validMove.y);
+		int newValue;
+		if (i == 0) {
+			newValue = -getPVSValue(-INT_MAX, INT_MAX, board, OPP(player), depth - 1);
+		} else {
+			// Moves with the same value as the best move are also returned, so only prove that 
+			// the move is worse than the best move. Otherwise, get its exact value.
+			newValue = -getPVSValue(-value, -value + 1, board, OPP(player), depth - 1);
+			if (newValue >= value) {
+				newValue = -getPVSValue(-INT_MAX, -value + 1, board, OPP(player), depth - 1);
 			}
 		}
+		board.undoMove();
+
+		if (newValue > value) {
+			// Clear previous moves
+			value = newValue;
+			minimaxMoves.clear();
+			minimaxMoves.push_back(validMove);
+
+		} else if (newValue == value) {
+			// Add on to a previous move with same value
+			minimaxMoves.push_back(validMove);
+		}
 	}
-	return scoreBlack - scoreWhite;
+
+	after = wallClockTime();
+	long long totalTime = after - startTime;
+	printf("     [TOTAL TIME TAKEN: %6.2f s]\n\n", totalTime / 1000000000.0);
+
+	return minimaxMoves;
 }
 
-int Solver::evaluateDepthLimitedBoard(Board board) {
-	// Would not have searched entire space if this evaluation function is used
-	searchedEntireSpace = false;
+int Solver::getPVSValue(int alpha, int beta, Board& board, int player, int depth) {
+	// Value does not matter as the search will be discarded
+	if (isOutOfTime()) {
+		return 0;
+	}
+
+	// Evaluate boards (From the perspective of the player)
+	int sign = (player == BLACK) ? 1 : -1;
+	if (board.isGameOver()) {
+		return sign * evaluateBoard(board);
+	} else if (depth == 0 || boardsSearched >= maxBoards) {
+		return sign * evaluateDepthLimitedBoard(board);
+	}
+
+	// Values in the transposition table are from BLACK's perspective
+	uint64_t hash = board.getHash(player);
+	int value, hashMove;
+	bool found = (player == BLACK) ? probeTranspositionTable(hash, alpha, beta, depth, &value, &hashMove) :
+									 probeTranspositionTable(hash, -beta, -alpha, depth, &value, &hashMove);
+	if (found) {
+		return sign * value;
+	}
 
-	int scoreWhite = 0;
-	int scoreBlack = 0;
-	int incrementBy = 1;
-	for (int i = 0; i < width; i++) {
-		for (int j = 0; j < height; j++) {
-			// Increment by different values for different areas of the board
-			if ((i == 0 && j == 0) || (i == width - 1 && j == 0) || 
-				(i == 0 && j == height - 1) || (i == width - 1 && j == height - 1)) {
-				// Corners
-				incrementBy = cornerValue;
-			} else if (i == 0 || i == width - 1 || j == 0 || j == height - 1) {
-				// Edges
-				incrementBy = edgeValue;
-			} else {
-				incrementBy = 1;
+	vector<point>& validMoves = getMoveList(depth);
+	board.getValidMoves(player, validMoves);
+	if (validMoves.size() == 0) {
+		// Skip to next player if no moves
+		return -getPVSValue(-beta, -alpha, board, OPP(player), depth);
+	}
+	orderMoves(validMoves, player, depth, hashMove);
+	prefetchChildren(board, validMoves, player, depth);
+
+	int alphaOriginal = alpha;
+	int bestMove = -1;
+	value = -INT_MAX;
+	for (int i = 0; i < validMoves.size(); i++) {
+		point validMove = validMoves[i];
+		boardsSearched++;
+		board.makeMove(player, validMove.x, validMove.y);
+		int newValue;
+		if (i == 0) {
+			newValue = -getPVSValue(-beta, -alpha, board, OPP(player), depth - 1);
+		} else {
+			// Null window search, then search again if the move is better than the best move
+			newValue = -getPVSValue(-alpha - 1, -alpha, board, OPP(player), depth - 1);
+			if (newValue > alpha && newValue < beta) {
+				newValue = -getPVSValue(-beta, -alpha, board, OPP(player), depth - 1);
 			}
+		}
+		board.undoMove();
+		if (newValue > value) {
+			value = newValue;
+			bestMove = validMove.x * height + validMove.y;
+		}
+
+		// Pruning
+		if (value >= beta) {
+			recordCutoff(player, depth, bestMove);
+			break;
+		}
+		alpha = max(alpha, value);
+	}
 
-			if (board.getDisk(i, j) == WHITE) {
-				scoreWhite += incrementBy;
-			} else if (board.getDisk(i, j) == BLACK) {
-				scoreBlack += incrementBy;
+	if (player == BLACK) {
+		storeTranspositionTable(hash, alphaOriginal, beta, depth, value, bestMove);
+	} else {
+		storeTranspositionTable(hash, -beta, -alphaOriginal, depth, -value, bestMove);
+	}
+	return value;
+}
+
+/*
+ * MTD(f): Converges on the minimax value of the board with a series of null window alpha-beta 
+ * searches, starting from the value of the previous search (eg. the previous depth of iterative 
+ * deepening). Relies on the transposition table to not search the same boards again in every pass.
+ *
+ * The moves with the minimax value are then found with a null window search of each move.
+ */
+vector<point> Solver::getMTDFMoves(Board board, int player, int depth) {
+	// Timing
+	long long startTime = wallClockTime();
+	long long after;
+
+	startSearch();
+
+	vector<point> validMoves = board.getValidMoves(player);
+	if (validMoves.size() == 0) {
+		return vector<point>();
+	} else if (validMoves.size() == 1) {
+		return validMoves;
+	}
+
+	// Narrow the bounds of the value until they meet
+	int value = mtdfGuess;
+	int lowerBound = INT_MIN;
+	int upperBound = INT_MAX;
+	int passes = 0;
+	while (lowerBound < upperBound && !timedOut) {
+		int beta = (value == lowerBound) ? value + 1 : value;
+		int boardsBefore = boardsSearched;
+		value = (player == BLACK) ? getAlphaBetaMaxValue(beta - 1, beta, board, player, depth) :
+									getAlphaBetaMinValue(beta - 1, beta, board, player, depth);
+		if (value < beta) {
+			upperBound = value;
+		} else {
+			lowerBound = value;
+		}
+		passes++;
+		printf("=== MTD(f) pass %2d: Window (%d, %d), Value %d, Boards assessed %d ===\n", 
+			passes, beta - 1, beta, value, boardsSearched - boardsBefore);
+	}
+	mtdfGuess = value;
+	printf("=== MTD(f) converged to %d in %d passes ===\n", value, passes);
+
+	// Moves that are not worse than the minimax value for the player
+	vector<point> minimaxMoves;
+	for (point validMove : validMoves) {
+		board.makeMove(player, validMove.x, validMove.y);
+		bool isBest = (player == BLACK) ? getAlphaBetaMinValue(value - 1, value, board, OPP(player), depth - 1) >= value :
+										  getAlphaBetaMaxValue(value, value + 1, board, OPP(player), depth - 1) <= value;
+		board.undoMove();
+
+		if (isBest) {
+			minimaxMoves.push_back(validMove);
+		}
+	}
+
+	after = wallClockTime();
+	long long totalTime = after - startTime;
+	printf("     [TOTAL TIME TAKEN: %6.2f s]\n\n", totalTime / 1000000000.0);
+
+	return minimaxMoves;
+}
+
+// Returns true if the stored value of the position can be used for the window (alpha, beta)
+// The best move stored is returned even if the value cannot be used (-1 if there is none)
+bool Solver::probeTranspositionTable(uint64_t hash, int alpha, int beta, int depth, int* value, int* bestMove) {
+	TTEntry entry;
+	*bestMove = -1;
+	if (table == NULL) {
+		return false;
+	}
+
+	// Positions searched by other processes that have been read (See prefetchChildren)
+	receiveDistributedTable(table, depth);
+	if (!table->probe(hash, &entry)) {
+		return false;
+	}
+
+	*bestMove = entry.bestMove;
+	if (entry.depth < depth) {
+		return false;
+	}
+
+	int bound = TranspositionTable::getBound(&entry);
+	if (bound == TT_EXACT || (bound == TT_LOWER && entry.value >= beta) || 
+		(bound == TT_UPPER && entry.value <= alpha)) {
+		*value = entry.value;
+		return true;
+	}
+	return false;
+}
+
+// Stores the value of a position searched with the window (alpha, beta)
+void Solver::storeTranspositionTable(uint64_t hash, int alpha, int beta, int depth, int value, int bestMove) {
+	// Values of a search that ran out of time are not correct
+	if (table == NULL || timedOut) {
+		return;
+	}
+
+	int bound = TT_EXACT;
+	if (value <= alpha) {
+		bound = TT_UPPER;
+	} else if (value >= beta) {
+		bound = TT_LOWER;
+	}
+	table->store(hash, depth, bound, value, bestMove);
+	storeDistributedTable(hash, depth, bound, value, bestMove);
+}
+
+// Starts reading the positions after the moves from the distributed table, so that they are
+// likely to have arrived by the time they are searched (The first move is searched right away)
+void Solver::prefetchChildren(Board& board, vector<point>& moves, int player, int depth) {
+	if (table == NULL || !usesDistributedTable(depth - 1)) {
+		return;
+	}
+	for (int i = 1; i < moves.size(); i++) {
+		board.makeMove(player, moves[i].x, moves[i].y);
+		prefetchDistributedTable(board.getHash(OPP(player)), depth - 1);
+		board.undoMove();
+	}
+}
+
+/******************************* MOVE ORDERING *******************************/
+
+// Static priority of each cell: Corners first, then edges, with the cells next to the corners last
+void Solver::initMoveOrdering() {
+	int numCells = width * height;
+	cellPriority.assign(numCells, 0);
+	historyScores.assign(3 * numCells, 0);
+
+	for (int x = 0; x < width; x++) {
+		for (int y = 0; y < height; y++) {
+			// Distance from the nearest corner
+			int dx = min(x, width - 1 - x);
+			int dy = min(y, height - 1 - y);
+			int priority = 0;
+			if (dx == 0 && dy == 0) {
+				priority = CORNER_PRIORITY;
+			} else if (dx == 1 && dy == 1) {
+				priority = X_SQUARE_PRIORITY;
+			} else if (dx + dy == 1) {
+				priority = C_SQUARE_PRIORITY;
+			} else if (dx == 0 || dy == 0) {
+				priority = EDGE_PRIORITY;
 			}
+			cellPriority[x * height + y] = priority;
+		}
+	}
+}
+
+// Killer moves only apply to the current search. History is kept but aged.
+// Helper threads of Lazy SMP change the priorities of the cells a little so that they do not 
+// search the moves in the same order as the other threads
+void Solver::perturbMoveOrdering(int seed) {
+	for (int i = 0; i < cellPriority.size(); i++) {
+		uint64_t h = ((uint64_t) seed * 0x9E3779B97F4A7C15ULL) ^ ((uint64_t) i * 0xBF58476D1CE4E5B9ULL);
+		h ^= h >> 31;
+		cellPriority[i] += (int) (h % 7) - 3;
+	}
+}
+
+// Start a new search of the transposition table and the move ordering (Done by getLazySMPMoves
+// before the helper threads start, so that they never read the generation while it changes)
+void Solver::startSearch() {
+	if (searchStarted) {
+		return;
+	}
+	if (table != NULL) {
+		table->newSearch();
+	}
+	resetMoveOrdering();
+}
+
+void Solver::resetMoveOrdering() {
+	fill(killerMoves.begin(), killerMoves.end(), -1);
+	for (int i = 0; i < historyScores.size(); i++) {
+		historyScores[i] /= 2;
+	}
+}
+
+// Valid moves of the board in the order that they should be searched
+void Solver::getOrderedMoves(Board& board, int player, int depth, vector<point>& moves) {
+	board.getValidMoves(player, moves);
+
+	int value, hashMove;
+	probeTranspositionTable(board.getHash(player), INT_MIN, INT_MAX, depth, &value, &hashMove);
+	getMoveList(depth);
+	orderMoves(moves, player, depth, hashMove);
+}
+
+// Sorts the moves so that those most likely to cause a cutoff are searched first: The best move 
+// from the transposition table, the killer moves of the depth, then by history and cell priority
+void Solver::orderMoves(vector<point>& moves, int player, int depth, int hashMove) {
+	vector<int>& scores = moveScores[depth];
+	scores.resize(moves.size());
+	int* killers = &killerMoves[depth * 2];
+	int numCells = width * height;
+
+	for (int i = 0; i < moves.size(); i++) {
+		int move = moves[i].x * height + moves[i].y;
+		if (move == hashMove) {
+			scores[i] = HASH_MOVE_PRIORITY;
+		} else if (move == killers[0]) {
+			scores[i] = KILLER_MOVE_PRIORITY;
+		} else if (move == killers[1]) {
+			scores[i] = KILLER_MOVE_PRIORITY - 1;
+		} else {
+			scores[i] = historyScores[player * numCells + move] + cellPriority[move];
+		}
+	}
+
+	// Insertion sort as there are few moves. Moves with the same score keep their order.
+	for (int i = 1; i < moves.size(); i++) {
+		point move = moves[i];
+		int score = scores[i];
+		int j = i - 1;
+		for (; j >= 0 && scores[j] < score; j--) {
+			moves[j + 1] = moves[j];
+			scores[j + 1] = scores[j];
+		}
+		moves[j + 1] = move;
+		scores[j + 1] = score;
+	}
+}
+
+// Remembers the move that caused a cutoff so that it is tried early in sibling nodes
+void Solver::recordCutoff(int player, int depth, int move) {
+	int* killers = &killerMoves[depth * 2];
+	if (killers[0] != move) {
+		killers[1] = killers[0];
+		killers[0] = move;
+	}
+	int& history = historyScores[player * width * height + move];
+	history += depth * depth;
+
+	// Keep history scores below the priority of killer moves
+	if (history >= KILLER_MOVE_PRIORITY / 2) {
+		for (int i = 0; i < historyScores.size(); i++) {
+			historyScores[i] /= 2;
 		}
 	}
-	return scoreBlack - scoreWhite;
+}
+
+int Solver::evaluateBoard(Board& board) {
+	return board.countDisks(BLACK) - board.countDisks(WHITE);
+}
+
+int Solver::evaluateDepthLimitedBoard(Board& board) {
+	// Would not have searched entire space if this evaluation function is used
+	searchedEntireSpace = false;
+
+	// Increment by different values for different areas of the board
+	int scores[3] = {0, 0, 0};
+	for (int player = BLACK; player <= WHITE; player++) {
+		int corners = board.countCornerDisks(player);
+		int edges = board.countEdgeDisks(player);
+		int others = board.countDisks(player) - corners - edges;
+		scores[player] = corners * cornerValue + edges * edgeValue + others;
+	}
+	return scores[BLACK] - scores[WHITE];
 }
 
 // Helpers
+// Each depth has its own list of moves so that the search does not allocate at every node.
+// (A deque is used as growing it does not move the lists that are being iterated over)
+vector<point>& Solver::getMoveList(int depth) {
+	if (depth >= moveLists.size()) {
+		moveLists.resize(depth + 1);
+		moveScores.resize(depth + 1);
+		killerMoves.resize((depth + 1) * 2, -1);
+	}
+	return moveLists[depth];
+}
+
+void Solver::setTranspositionTable(TranspositionTable* t) { table = t; }
 bool Solver::getSearchedEntireSpace() { return searchedEntireSpace; }
 int Solver::getBoardsSearched() { return boardsSearched; }
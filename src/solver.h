@@ -7,10 +7,20 @@
 #include "point.h"
 #include "board.h"
 #include "config.h"
+#include "transposition.h"
+#include "jobtree.h"
 
 #ifndef SOLVER_H
 #define SOLVER_H
 
+// Priorities of moves when ordering moves (Higher is searched first)
+#define HASH_MOVE_PRIORITY (1 << 30)
+#define KILLER_MOVE_PRIORITY (1 << 29)
+#define CORNER_PRIORITY 64
+#define EDGE_PRIORITY 8
+#define C_SQUARE_PRIORITY -8
+#define X_SQUARE_PRIORITY -64
+
 using namespace std;
 
 class Solver {
@@ -18,34 +28,78 @@ class Solver {
 		Solver(Config cf) : width(cf.getWidth()), height(cf.getHeight()),
 			maxDepth(cf.getMaxDepth()), maxBoards(cf.getMaxBoards()), 
 			cornerValue(cf.getCornerValue()), edgeValue(cf.getEdgeValue()),
-			searchedEntireSpace(true), boardsSearched(0) {}
+			tableSize(cf.getTableSize()), timeout(cf.getTimeout()), 
+			searchedEntireSpace(true), boardsSearched(0), table(NULL), mtdfGuess(0),
+			deadline(0), timedOut(false), timeChecks(0), abortableJob(-1), stopSearch(NULL), searchStarted(false) { initMoveOrdering(); }
 		Solver(int w, int h, int maxD, int maxB, int cornerV, int edgeV) :
 			width(w), height(h), maxDepth(maxD), maxBoards(maxB), 
-			cornerValue(cornerV), edgeValue(edgeV), 
-			searchedEntireSpace(true), boardsSearched(0) {}
-		
+			cornerValue(cornerV), edgeValue(edgeV), tableSize(0), timeout(0),
+			searchedEntireSpace(true), boardsSearched(0), table(NULL), mtdfGuess(0),
+			deadline(0), timedOut(false), timeChecks(0), abortableJob(-1), stopSearch(NULL), searchStarted(false) { initMoveOrdering(); }
+
+		/************************** ITERATIVE DEEPENING ***************************/
+		vector<point> getBestMoves(Board board, int player, int depth, int numProcs,
+			string algorithm, string jobDistribution, int numJobsPerProc, int jobPoolSendSize);
+		vector<point> getMoves(Board board, int player, int depth, int numProcs,
+			string algorithm, string jobDistribution, int numJobsPerProc, int jobPoolSendSize);
+		void setDeadline(long long d);
+		bool isOutOfTime();
+		void setAbortableJob(int jobId);
+		void setStopFlag(atomic<bool>* stop);
+
 		/*************************** PARALLEL ALGORITHMS **************************/		
 		vector<point> getBatchMoves(Board board, int player, int depth, int numProcs,
 			string algorithm, string jobDistribution, int numJobsPerProc);
 		vector<point> getJobPoolMoves(Board board, int player, int depth, int numProcs,
-			string jobDistribution, int numJobsPerProc, int jobPoolSendSize);
+			string algorithm, string jobDistribution, int numJobsPerProc, int jobPoolSendSize);
+		vector<point> getYBWCMoves(Board board, int player, int depth, int numProcs, int numJobsPerProc);
+		vector<point> getWorkStealingMoves(Board board, int player, int depth, int numProcs,
+			string algorithm, int numJobsPerProc);
+		vector<point> getRMAMoves(Board board, int player, int depth, int numProcs,
+			string algorithm, int numJobsPerProc);
+		vector<point> getLazySMPMoves(Board board, int player, int depth, string algorithm);
+		void searchLazySMPHelper(Board board, int player, int depth, string algorithm, int helperId);
+		void printMasterTime(long long startTime, long long commTime, long long compTime);
 
 		/************************** SEQUENTIAL ALGORITHMS **************************/
 		// Minimax
 		vector<point> getMinimaxMoves(Board board, int player, int depth);
-		int getMinValue(Board board, int player, int depth);
-		int getMaxValue(Board board, int player, int depth);
+		int getMinValue(Board& board, int player, int depth);
+		int getMaxValue(Board& board, int player, int depth);
 
 		// Minimax with alpha-beta pruning
 		vector<point> getAlphaBetaMoves(Board board, int player, int depth);
-		int getAlphaBetaMinValue(int alpha, int beta, Board board, int player, int depth);
-		int getAlphaBetaMaxValue(int alpha, int beta, Board board, int player, int depth);
+		int getAlphaBetaMinValue(int alpha, int beta, Board& board, int player, int depth);
+		int getAlphaBetaMaxValue(int alpha, int beta, Board& board, int player, int depth);
+
+		// Principal variation search (Negamax)
+		vector<point> getPVSMoves(Board board, int player, int depth);
+		int getPVSValue(int alpha, int beta, Board& board, int player, int depth);
+
+		// MTD(f)
+		vector<point> getMTDFMoves(Board board, int player, int depth);
+
+		// Transposition table
+		bool probeTranspositionTable(uint64_t hash, int alpha, int beta, int depth, int* value, int* bestMove);
+		void storeTranspositionTable(uint64_t hash, int alpha, int beta, int depth, int value, int bestMove);
+		void prefetchChildren(Board& board, vector<point>& moves, int player, int depth);
+
+		// Move ordering
+		void initMoveOrdering();
+		void getOrderedMoves(Board& board, int player, int depth, vector<point>& moves);
+		void startSearch();
+		void resetMoveOrdering();
+		void perturbMoveOrdering(int seed);
+		void orderMoves(vector<point>& moves, int player, int depth, int hashMove);
+		void recordCutoff(int player, int depth, int move);
 
 		// Scoring
-		int evaluateBoard(Board board);
-		int evaluateDepthLimitedBoard(Board board);
+		int evaluateBoard(Board& board);
+		int evaluateDepthLimitedBoard(Board& board);
 
 		// Helpers
+		vector<point>& getMoveList(int depth);
+		void setTranspositionTable(TranspositionTable* t);
 		bool getSearchedEntireSpace();
 		int getBoardsSearched();
 
@@ -57,10 +111,29 @@ class Solver {
 		int maxBoards;
 		int cornerValue;
 		int edgeValue;
+		int tableSize;
+		int timeout;
 
 		// State
 		bool searchedEntireSpace;
 		int boardsSearched;
+		deque<vector<point> > moveLists;
+		TranspositionTable* table;
+		int mtdfGuess;		// First guess of MTD(f), the value of the previous search
+
+		// Move ordering (Killer moves are indexed by depth as the search is depth-first)
+		vector<int> cellPriority;
+		vector<int> historyScores;
+		vector<int> killerMoves;
+		deque<vector<int> > moveScores;
+
+		// Timeout
+		long long deadline;
+		bool timedOut;
+		int timeChecks;
+		int abortableJob;
+		atomic<bool>* stopSearch;	// Set by the main thread of Lazy SMP (See getLazySMPMoves)
+		bool searchStarted;			// Lazy SMP started the search before its helpers (See startSearch)
 };
 
 #endif
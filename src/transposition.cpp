@@ -0,0 +1,135 @@
+#include "transposition.h"
+
+using namespace std;
+
+TranspositionTable::TranspositionTable(int sizeInMB) : 
+	buckets(NULL), numBuckets(0), generation(0), ownsBuckets(true) {
+	// A size of 0 disables the table
+	if (sizeInMB <= 0) {
+		return;
+	}
+
+	numBuckets = getNumBuckets(sizeInMB);
+	void* memory;
+	if (posix_memalign(&memory, sizeof(TTBucket), numBuckets * sizeof(TTBucket)) != 0) {
+		printf("--- ERROR: Could not allocate transposition table of %d MB ---\n", sizeInMB);
+		numBuckets = 0;
+		return;
+	}
+	buckets = (TTBucket*) memory;
+	clear();
+}
+
+// Table in memory allocated by the caller (eg. shared by the processes of a node), not cleared
+TranspositionTable::TranspositionTable(TTBucket* memory, long long n) : 
+	buckets(memory), numBuckets(n), generation(0), ownsBuckets(false) {}
+
+TranspositionTable::~TranspositionTable() {
+	if (ownsBuckets) {
+		free(buckets);
+	}
+}
+
+// Number of buckets is rounded down to a power of 2 so that the key can be masked
+long long TranspositionTable::getNumBuckets(int sizeInMB) {
+	long long maxBuckets = (long long) sizeInMB * 1024 * 1024 / sizeof(TTBucket);
+	long long n = 1;
+	while (n * 2 <= maxBuckets) {
+		n *= 2;
+	}
+	return n;
+}
+
+uint64_t TranspositionTable::packEntry(TTEntry* entry) {
+	return (uint64_t) (uint32_t) entry->value | 
+		((uint64_t) (uint16_t) entry->bestMove << 32) | 
+		((uint64_t) entry->depth << 48) | 
+		((uint64_t) entry->flags << 56);
+}
+
+void TranspositionTable::unpackEntry(uint64_t data, TTEntry* entry) {
+	entry->value = (int32_t) (uint32_t) data;
+	entry->bestMove = (int16_t) (uint16_t) (data >> 32);
+	entry->depth = (uint8_t) (data >> 48);
+	entry->flags = (uint8_t) (data >> 56);
+}
+
+bool TranspositionTable::probe(uint64_t key, TTEntry* entry) {
+	if (numBuckets == 0) {
+		return false;
+	}
+	TTSlot* slots = buckets[key & (numBuckets - 1)].slots;
+	for (int i = 0; i < TT_BUCKET_SIZE; i++) {
+		uint64_t check = __atomic_load_n(&slots[i].check, __ATOMIC_RELAXED);
+		uint64_t data = __atomic_load_n(&slots[i].data, __ATOMIC_RELAXED);
+		if ((check ^ data) == key) {
+			unpackEntry(data, entry);
+			if (entry->flags == TT_EMPTY) {
+				return false;
+			}
+			entry->key = key;
+			return true;
+		}
+	}
+	return false;
+}
+
+void TranspositionTable::store(uint64_t key, int depth, int bound, int value, int bestMove) {
+	if (numBuckets == 0) {
+		return;
+	}
+	TTSlot* slots = buckets[key & (numBuckets - 1)].slots;
+
+	// Replace the same position if it is there, else the shallowest entry from the oldest search
+	TTSlot* replace = &slots[0];
+	int replaceScore = 0x7FFFFFFF;
+	for (int i = 0; i < TT_BUCKET_SIZE; i++) {
+		TTEntry entry;
+		uint64_t check = __atomic_load_n(&slots[i].check, __ATOMIC_RELAXED);
+		uint64_t data = __atomic_load_n(&slots[i].data, __ATOMIC_RELAXED);
+		unpackEntry(data, &entry);
+		if ((check ^ data) == key) {
+			replace = &slots[i];
+			// Keep the best move of a previous search if this search did not find one
+			if (bestMove < 0 && entry.flags != TT_EMPTY) {
+				bestMove = entry.bestMove;
+			}
+			break;
+		}
+
+		int age = (generation - (entry.flags >> 2)) & 0x3F;
+		int score = (entry.flags == TT_EMPTY) ? -0x7FFFFFFF : entry.depth - age * 256;
+		if (score < replaceScore) {
+			replace = &slots[i];
+			replaceScore = score;
+		}
+	}
+
+	TTEntry entry;
+	entry.value = value;
+	entry.bestMove = bestMove;
+	entry.depth = (depth > 0xFF) ? 0xFF : depth;
+	entry.flags = (generation << 2) | bound;
+	uint64_t data = packEntry(&entry);
+	__atomic_store_n(&replace->check, key ^ data, __ATOMIC_RELAXED);
+	__atomic_store_n(&replace->data, data, __ATOMIC_RELAXED);
+}
+
+void TranspositionTable::newSearch() {
+	generation = (generation + 1) & 0x3F;
+}
+
+void TranspositionTable::clear() {
+	TTEntry empty;
+	empty.value = 0;
+	empty.bestMove = -1;
+	empty.depth = 0;
+	empty.flags = TT_EMPTY;
+	uint64_t data = packEntry(&empty);
+	for (long long i = 0; i < numBuckets; i++) {
+		for (int j = 0; j < TT_BUCKET_SIZE; j++) {
+			buckets[i].slots[j].check = data;
+			buckets[i].slots[j].data = data;
+		}
+	}
+}
@@ -0,0 +1,76 @@
+#ifndef TRANSPOSITION_H
+#define TRANSPOSITION_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+// Types of values stored in the table
+#define TT_EXACT 0
+#define TT_LOWER 1	// Value is a lower bound (Search failed high)
+#define TT_UPPER 2	// Value is an upper bound (Search failed low)
+#define TT_EMPTY 0xFF	// Flags of an unused entry (Bound type is never 3)
+
+// Entries per bucket (4 entries of 16 bytes = 1 cache line)
+#define TT_BUCKET_SIZE 4
+
+using namespace std;
+
+typedef struct {
+	uint64_t key;
+	int32_t value;
+	int16_t bestMove;	// Index of the cell of the best move (x * height + y), -1 if none
+	uint8_t depth;
+	uint8_t flags;		// Bound type (lowest 2 bits) and generation of the search (highest 6 bits)
+} TTEntry;
+
+// Stored form of an entry: data packs value, bestMove, depth and flags, and check is key ^ data.
+// Threads read and write both words without locks; a torn entry fails the check and is a miss.
+typedef struct {
+	uint64_t check;
+	uint64_t data;
+} TTSlot;
+
+typedef struct {
+	TTSlot slots[TT_BUCKET_SIZE];
+} __attribute__((aligned(64))) TTBucket;
+
+/*
+ * Fixed-size transposition table indexed by the Zobrist hash of a position (see Board::getHash).
+ * Values are stored from BLACK's perspective, as returned by the Solver.
+ * The table is lock-free and may be shared by the threads of a processor.
+ */
+class TranspositionTable {
+	public:
+		TranspositionTable(int sizeInMB);
+		TranspositionTable(TTBucket* memory, long long numBuckets);
+		~TranspositionTable();
+
+		// Returns true and fills in entry if the position has been stored
+		bool probe(uint64_t key, TTEntry* entry);
+		void store(uint64_t key, int depth, int bound, int value, int bestMove);
+
+		// Entries from older searches are replaced first
+		void newSearch();
+		void clear();
+
+		// Helpers
+		static int getBound(TTEntry* entry) { return entry->flags & 3; };
+		long long getNumEntries() { return numBuckets * TT_BUCKET_SIZE; };
+		static long long getNumBuckets(int sizeInMB);
+		static uint64_t packEntry(TTEntry* entry);
+		static void unpackEntry(uint64_t data, TTEntry* entry);
+
+	protected:
+		TTBucket* buckets;
+		long long numBuckets;
+		uint8_t generation;
+		bool ownsBuckets;	// False if the buckets are shared with other processes
+
+	private:
+		// Not copyable as the buckets may be owned by the table
+		TranspositionTable(const TranspositionTable &t);
+		TranspositionTable& operator=(const TranspositionTable &t);
+};
+
+#endif
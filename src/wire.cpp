@@ -0,0 +1,198 @@
+#include "wire.h"
+
+using namespace std;
+
+/********************************** WRITING **********************************/
+
+static void putUint8(vector<uint8_t>* message, int value) {
+	message->push_back((uint8_t)value);
+}
+
+static void putInt32(vector<uint8_t>* message, int32_t value) {
+	uint32_t bits = (uint32_t)value;
+	for (int i = 0; i < 4; i++) {
+		message->push_back((bits >> (8 * i)) & 0xFF);
+	}
+}
+
+static void putInt64(vector<uint8_t>* message, int64_t value) {
+	uint64_t bits = (uint64_t)value;
+	for (int i = 0; i < 8; i++) {
+		message->push_back((bits >> (8 * i)) & 0xFF);
+	}
+}
+
+static void putHeader(vector<uint8_t>* message, int type) {
+	message->clear();
+	putUint8(message, WIRE_VERSION);
+	putUint8(message, type);
+}
+
+/********************************** READING **********************************/
+
+// Reads a message from the start, failing once it reads past the end
+typedef struct {
+	vector<uint8_t>* message;
+	int offset;
+	bool failed;
+} Reader;
+
+static bool canRead(Reader* reader, int size) {
+	if (reader->offset + size > reader->message->size()) {
+		reader->failed = true;
+	}
+	return !reader->failed;
+}
+
+static int getUint8(Reader* reader) {
+	if (!canRead(reader, 1)) {
+		return 0;
+	}
+	return (*reader->message)[reader->offset++];
+}
+
+static int32_t getInt32(Reader* reader) {
+	if (!canRead(reader, 4)) {
+		return 0;
+	}
+	uint32_t bits = 0;
+	for (int i = 0; i < 4; i++) {
+		bits |= (uint32_t)(*reader->message)[reader->offset++] << (8 * i);
+	}
+	return (int32_t)bits;
+}
+
+static int64_t getInt64(Reader* reader) {
+	if (!canRead(reader, 8)) {
+		return 0;
+	}
+	uint64_t bits = 0;
+	for (int i = 0; i < 8; i++) {
+		bits |= (uint64_t)(*reader->message)[reader->offset++] << (8 * i);
+	}
+	return (int64_t)bits;
+}
+
+// True if the message has the current version and the given type
+static bool getHeader(Reader* reader, int type) {
+	int version = getUint8(reader);
+	int messageType = getUint8(reader);
+	if (reader->failed || version != WIRE_VERSION || messageType != type) {
+		printf("--- ERROR: Message of version %d and type %d (Expected version %d and type %d) ---\n",
+			version, messageType, WIRE_VERSION, type);
+		reader->failed = true;
+	}
+	return !reader->failed;
+}
+
+/********************************** SESSION **********************************/
+
+void packSession(vector<uint8_t>* message, Session* session) {
+	putHeader(message, WIRE_SESSION);
+	putInt32(message, session->width);
+	putInt32(message, session->height);
+	putInt32(message, session->maxBoards);
+	putInt32(message, session->cornerValue);
+	putInt32(message, session->edgeValue);
+	putInt32(message, session->tableSize);
+}
+
+bool unpackSession(vector<uint8_t>* message, Session* session) {
+	Reader reader = {message, 0, false};
+	if (!getHeader(&reader, WIRE_SESSION)) {
+		return false;
+	}
+	session->width = getInt32(&reader);
+	session->height = getInt32(&reader);
+	session->maxBoards = getInt32(&reader);
+	session->cornerValue = getInt32(&reader);
+	session->edgeValue = getInt32(&reader);
+	session->tableSize = getInt32(&reader);
+	return !reader.failed;
+}
+
+/************************************ JOBS ***********************************/
+
+void packJobs(vector<uint8_t>* message, vector<Job>* jobs, vector<Board>* boards, long long timeLimit) {
+	putHeader(message, WIRE_JOBS);
+	putInt32(message, jobs->size());
+	putInt64(message, timeLimit);
+
+	for (int k = 0; k < jobs->size(); k++) {
+		Job* job = &((*jobs)[k]);
+		putInt32(message, job->id);
+		putInt32(message, job->parentId);
+		putUint8(message, job->player);
+		putInt32(message, job->depthLeft);
+		putInt32(message, job->alpha);
+		putInt32(message, job->beta);
+
+		int offset = message->size();
+		message->resize(offset + (*boards)[k].getPackedSize());
+		(*boards)[k].pack(message->data() + offset);
+	}
+}
+
+bool unpackJobs(vector<uint8_t>* message, Session* session, vector<Job>* jobs) {
+	Reader reader = {message, 0, false};
+	jobs->clear();
+	if (!getHeader(&reader, WIRE_JOBS)) {
+		return false;
+	}
+	int numJobs = getInt32(&reader);
+	long long timeLimit = getInt64(&reader);
+
+	for (int k = 0; k < numJobs && !reader.failed; k++) {
+		Job job = {
+			0, 0, session->width, session->height, session->maxBoards,
+			session->cornerValue, session->edgeValue, session->tableSize,
+			0, 0, 0, 0, 0, timeLimit, NULL, 0
+		};
+		job.id = getInt32(&reader);
+		job.parentId = getInt32(&reader);
+		job.player = getUint8(&reader);
+		job.depthLeft = getInt32(&reader);
+		job.alpha = getInt32(&reader);
+		job.beta = getInt32(&reader);
+
+		Board* board = new Board(session->width, session->height);
+		if (canRead(&reader, board->getPackedSize())) {
+			board->unpack(message->data() + reader.offset);
+			reader.offset += board->getPackedSize();
+		}
+		job.board = board;
+		jobs->push_back(job);
+	}
+	return !reader.failed;
+}
+
+/******************************* COMPLETED JOBS ******************************/
+
+void packCompletedJobs(vector<uint8_t>* message, vector<CompletedJob>* jobs) {
+	putHeader(message, WIRE_COMPLETED_JOBS);
+	putInt32(message, jobs->size());
+
+	for (int k = 0; k < jobs->size(); k++) {
+		putInt32(message, (*jobs)[k].id);
+		putInt32(message, (*jobs)[k].moveValue);
+		putInt32(message, (*jobs)[k].boardsAssessed);
+	}
+}
+
+bool unpackCompletedJobs(vector<uint8_t>* message, vector<CompletedJob>* jobs) {
+	Reader reader = {message, 0, false};
+	jobs->clear();
+	if (!getHeader(&reader, WIRE_COMPLETED_JOBS)) {
+		return false;
+	}
+	int numJobs = getInt32(&reader);
+
+	for (int k = 0; k < numJobs && !reader.failed; k++) {
+		CompletedJob job = {0, -1, EMPTY, 0, 0, 0, 0};
+		job.id = getInt32(&reader);
+		job.moveValue = getInt32(&reader);
+		job.boardsAssessed = getInt32(&reader);
+		jobs->push_back(job);
+	}
+	return !reader.failed;
+}
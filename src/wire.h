@@ -0,0 +1,54 @@
+#ifndef WIRE_H
+#define WIRE_H
+
+#include <stdint.h>
+#include <vector>
+#include "board.h"
+#include "job.h"
+
+// Version of the format. Messages of other versions are rejected.
+#define WIRE_VERSION 1
+
+// Types of messages
+#define WIRE_SESSION 0
+#define WIRE_JOBS 1
+#define WIRE_COMPLETED_JOBS 2
+
+using namespace std;
+
+/*
+ * Format of the messages between Master and Slaves.
+ *
+ * Every message starts with the version and the type of the message (1 byte each). Integers are
+ * written in little-endian order with a fixed size, so that processes do not have to agree on
+ * the layout of the structs (eg. on nodes of different architectures).
+ *
+ * - Session (Once per run):	width, height, maxBoards, cornerValue, edgeValue, tableSize
+ * - Jobs:						number of Jobs, timeLimit (8 bytes), and for each Job:
+ * 								id, parentId, player (1 byte), depthLeft, alpha, beta,
+ * 								Board (Board::pack)
+ * - Completed Jobs:			number of Jobs, and for each Job: id, moveValue, boardsAssessed
+ */
+
+// Search parameters that are the same for every Job
+typedef struct {
+	int width;
+	int height;
+	int maxBoards;
+	int cornerValue;
+	int edgeValue;
+	int tableSize;
+} Session;
+
+void packSession(vector<uint8_t>* message, Session* session);
+bool unpackSession(vector<uint8_t>* message, Session* session);
+
+// Jobs get the search parameters of the session. Boards are allocated (See slaveFreeJobs).
+void packJobs(vector<uint8_t>* message, vector<Job>* jobs, vector<Board>* boards, long long timeLimit);
+bool unpackJobs(vector<uint8_t>* message, Session* session, vector<Job>* jobs);
+
+// Only the id, moveValue and boardsAssessed of Completed Jobs are sent (Master has the rest)
+void packCompletedJobs(vector<uint8_t>* message, vector<CompletedJob>* jobs);
+bool unpackCompletedJobs(vector<uint8_t>* message, vector<CompletedJob>* jobs);
+
+#endif